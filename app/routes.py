@@ -4,6 +4,13 @@ from app import app
 # Make sure to import current_app from flask
 from flask import render_template, current_app
 
+@app.after_request
+def add_isolation_headers(response):
+    """Cross-origin isolation lets the threaded WASM builds use SharedArrayBuffer."""
+    response.headers['Cross-Origin-Opener-Policy'] = 'same-origin'
+    response.headers['Cross-Origin-Embedder-Policy'] = 'require-corp'
+    return response
+
 @app.route('/')
 def index():
     """Renders the main application page."""
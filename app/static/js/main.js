@@ -1,13 +1,49 @@
 // app/static/js/main.js
 
 const wasmModules = {};
+// Exports main.js calls in each module. A build in app/static/wasm older than
+// crypto_src is refused with a prompt to rerun built_wasm.sh rather than
+// driven through a different ABI.
+const requiredExports = {
+    aes: ['aes_create_context', 'aes_context_process'],
+    des: ['des_create_context', 'des_context_process', 'des_key_search_create'],
+    rsa: ['rsa_encrypted_size', 'rsa_encrypt', 'rsa_decrypt', 'rsa_factor_create'],
+    dh: ['dh_public_key', 'dh_shared_secret'],
+    ecc: ['x25519_generate_keys', 'x25519_shared_secret']
+};
+function missingExports(name, Module) {
+    return (requiredExports[name] || []).filter(f => typeof Module[`_${f}`] !== 'function');
+}
+// Modules with a pthreads build (<name>_mt.js) in built_wasm.sh
+const threadedModules = ['aes', 'des', 'rsa'];
 async function loadWasmModule(name) {
     if (name === 'ecies' || name === 'ecc_encryption') name = 'ecies';
     if (name === 'ecdh') name = 'ecc';
     if (wasmModules[name]) return wasmModules[name];
+    // Cross-origin isolated pages can use the threaded builds, when
+    // built_wasm.sh has produced them
+    if (threadedModules.includes(name) && self.crossOriginIsolated
+        && (await fetch(`/static/wasm/${name}_mt.js`, { method: 'HEAD' }).catch(() => null))?.ok) {
+        try {
+            const moduleFactory = (await import(`/static/wasm/${name}_mt.js`)).default;
+            const moduleInstance = await moduleFactory();
+            const missing = missingExports(name, moduleInstance);
+            if (missing.length) throw new Error(`missing ${missing.join(', ')}`);
+            console.log(`${name}_mt WASM module loaded.`);
+            wasmModules[name] = moduleInstance;
+            return moduleInstance;
+        } catch (e) {
+            console.warn(`Threaded ${name} unavailable, using single-threaded build:`, e);
+        }
+    }
     try {
         const moduleFactory = (await import(`/static/wasm/${name}.js`)).default;
         const moduleInstance = await moduleFactory();
+        const missing = missingExports(name, moduleInstance);
+        if (missing.length) {
+            alert(`The ${name} WASM module is older than crypto_src. Rerun built_wasm.sh to rebuild app/static/wasm.`);
+            throw new Error(`${name}.wasm is missing ${missing.join(', ')}`);
+        }
         console.log(`${name} WASM module loaded.`);
         wasmModules[name] = moduleInstance;
         return moduleInstance;
@@ -17,6 +53,83 @@ async function loadWasmModule(name) {
     }
 }
 
+// Expanded key schedules stay in WASM memory while the key is unchanged,
+// so repeated messages under one key skip key setup entirely
+const cipherContexts = {};
+function getCipherContext(Module, name, keyBytes) {
+    const keyId = keyBytes.join(',');
+    const cached = cipherContexts[name];
+    if (cached && cached.module === Module && cached.keyId === keyId) return cached.ctx;
+    if (cached) {
+        cached.module.cwrap(`${name}_destroy_context`, 'number', ['number'])(cached.ctx);
+        delete cipherContexts[name];
+    }
+
+    const keyPtr = Module._malloc(keyBytes.length);
+    if (!keyPtr) return 0;
+    Module.HEAPU8.set(keyBytes, keyPtr);
+    const ctx = (name === 'aes')
+        ? Module.cwrap('aes_create_context', 'number', ['number', 'number'])(keyPtr, keyBytes.length)
+        : Module.cwrap(`${name}_create_context`, 'number', ['number'])(keyPtr);
+    Module.HEAPU8.fill(0, keyPtr, keyPtr + keyBytes.length);
+    Module._free(keyPtr);
+    if (ctx) cipherContexts[name] = { module: Module, keyId, ctx };
+    return ctx;
+}
+
+// Mode numbers for the *_context_process exports (see crypto_src/Common/block_modes.h)
+const MODE_ECB = 0, MODE_CTR = 4;
+
+// Padding numbers for rsa_encrypt/rsa_decrypt (see crypto_src/RSA/rsa.cpp)
+const RSA_PADDING_PKCS1 = 1, RSA_PADDING_OAEP = 2;
+
+// Encrypts or decrypts bytes in modulus-sized RSA blocks. OAEP is used when
+// the modulus is wide enough for it (536 bits and up), PKCS#1 v1.5 otherwise,
+// so both directions pick the same padding from n alone. Returns null on error.
+function rsaProcessBytes(Module, dataBytes, n, key, encrypt) {
+    const c_size = Module.cwrap('rsa_encrypted_size', 'number', ['string', 'number', 'number']);
+    const c_process = Module.cwrap(encrypt ? 'rsa_encrypt' : 'rsa_decrypt', 'number', ['number', 'number', 'string', 'string', 'number', 'number']);
+    const padding = c_size(n, 0, RSA_PADDING_OAEP) > 0 ? RSA_PADDING_OAEP : RSA_PADDING_PKCS1;
+    const outLen = encrypt ? c_size(n, dataBytes.length, padding) : dataBytes.length;
+    if (outLen <= 0) return null;
+
+    const dataPtr = Module._malloc(Math.max(dataBytes.length, 1)), outputPtr = Module._malloc(outLen);
+    try {
+        if (!dataPtr || !outputPtr) return null;
+        Module.HEAPU8.set(dataBytes, dataPtr);
+        const written = c_process(dataPtr, dataBytes.length, n, key, padding, outputPtr);
+        return written < 0 ? null : Module.HEAPU8.slice(outputPtr, outputPtr + written);
+    } finally {
+        if (dataPtr) Module._free(dataPtr);
+        if (outputPtr) Module._free(outputPtr);
+    }
+}
+
+// Runs AES-CTR over data in fixed-size chunks so WASM memory use stays constant
+const AES_CTR_CHUNK = 64 * 1024;
+function aesCtrStream(Module, ctx, iv, dataBytes) {
+    const c_process = Module.cwrap('aes_context_process', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'boolean']);
+
+    // The counter block sits in WASM memory ahead of the data buffer and is
+    // advanced by each call
+    const chunkSize = Math.max(1, Math.min(AES_CTR_CHUNK, dataBytes.length));
+    const ivPtr = Module._malloc(16 + chunkSize);
+    if (!ivPtr) return null;
+    const bufPtr = ivPtr + 16;
+    Module.HEAPU8.set(iv, ivPtr);
+
+    const output = new Uint8Array(dataBytes.length);
+    let ok = true;
+    for (let offset = 0; ok && offset < dataBytes.length; offset += chunkSize) {
+        const chunk = dataBytes.subarray(offset, offset + chunkSize);
+        Module.HEAPU8.set(chunk, bufPtr);
+        ok = c_process(ctx, bufPtr, chunk.length, ivPtr, MODE_CTR, bufPtr, true) === 1;
+        output.set(Module.HEAPU8.subarray(bufPtr, bufPtr + chunk.length), offset);
+    }
+    Module._free(ivPtr);
+    return ok ? output : null;
+}
+
 document.addEventListener('DOMContentLoaded', () => {
     // --- Element References ---
     const cryptoTypeRadios = document.querySelectorAll('input[name="crypto-type"]');
@@ -75,6 +188,7 @@ document.addEventListener('DOMContentLoaded', () => {
 
         if (type === 'symmetric') {
             panels.symmetric.style.display = 'block';
+            document.getElementById('des-search-panel').style.display = (algorithm === 'des') ? 'block' : 'none';
         } else if (type === 'asymmetric') {
             if (algorithm === 'rsa') panels.rsa.style.display = 'block';
             else if (algorithm === 'ecies') panels.ecies.style.display = 'block';
@@ -139,21 +253,52 @@ document.addEventListener('DOMContentLoaded', () => {
                 const c_encrypt = Module.cwrap('encrypt', 'string', ['string', 'string']);
                 const c_decrypt = Module.cwrap('decrypt', 'string', ['string', 'string']);
                 result = (action === 'encrypt') ? c_encrypt(text, key) : c_decrypt(text, key);
-            } else if (algorithm === 'aes' || algorithm === 'des') {
+            } else if (algorithm === 'aes') {
                 if (!key) { alert('Please provide a key.'); return; }
-                const blockSize = (algorithm === 'aes') ? 16 : 8;
-                if (key.length !== blockSize) { alert(`Invalid key: ${algorithm.toUpperCase()} key must be exactly ${blockSize} characters long.`); return; }
-                
-                // Both AES and DES now return error codes
-                let c_process;
-                if (algorithm === 'aes') {
-                    c_process = Module.cwrap('process_aes', 'number', ['number', 'number', 'number', 'number', 'boolean']);
+                if (key.length !== 16) { alert('Invalid key: AES key must be exactly 16 characters long.'); return; }
+
+                // AES runs in CTR mode: no padding, ciphertext is base64(counter block || data)
+                const encoder = new TextEncoder(), decoder = new TextDecoder();
+                const keyBytes = encoder.encode(key.padEnd(16, '\0')).slice(0, 16);
+                let iv, dataBytes;
+                if (action === 'encrypt') {
+                    iv = crypto.getRandomValues(new Uint8Array(16));
+                    dataBytes = encoder.encode(text);
                 } else {
-                    c_process = Module.cwrap('process_des', 'number', ['number', 'number', 'number', 'number', 'boolean']);
+                    let rawBytes;
+                    try { rawBytes = Uint8Array.from(atob(text), c => c.charCodeAt(0)); }
+                    catch (e) { alert('Invalid Base64 input for decryption.'); return; }
+                    if (rawBytes.length < 16) { alert('Invalid ciphertext. It must start with a 16-byte counter block.'); return; }
+                    iv = rawBytes.slice(0, 16);
+                    dataBytes = rawBytes.slice(16);
                 }
+
+                const ctx = getCipherContext(Module, 'aes', keyBytes);
+                if (!ctx) { alert('AES key setup failed. Please try again.'); return; }
+                const resultBytes = aesCtrStream(Module, ctx, iv, dataBytes);
+                if (!resultBytes) { alert('AES processing failed. Please check your input and try again.'); return; }
+
+                if (action === 'encrypt') {
+                    const packed = new Uint8Array(16 + resultBytes.length);
+                    packed.set(iv); packed.set(resultBytes, 16);
+                    let binary = '';
+                    for (const b of packed) binary += String.fromCharCode(b);
+                    result = btoa(binary);
+                } else {
+                    result = decoder.decode(resultBytes);
+                }
+            } else if (algorithm === 'des') {
+                if (!key) { alert('Please provide a key.'); return; }
+                const blockSize = 8;
+                if (key.length !== blockSize) { alert(`Invalid key: ${algorithm.toUpperCase()} key must be exactly ${blockSize} characters long.`); return; }
+                
+                // DES returns an error code
+                const c_process = Module.cwrap('des_context_process', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'boolean']);
                 
                 const encoder = new TextEncoder(), decoder = new TextDecoder();
                 const keyBytes = encoder.encode(key.padEnd(blockSize, '\0')).slice(0, blockSize);
+                const ctx = getCipherContext(Module, 'des', keyBytes);
+                if (!ctx) { alert('DES key setup failed. Please try again.'); return; }
                 let dataBytes;
                 if (action === 'encrypt') {
                     const originalBytes = encoder.encode(text);
@@ -167,11 +312,10 @@ document.addEventListener('DOMContentLoaded', () => {
                     } catch (e) { alert('Invalid Base64 input for decryption.'); return; }
                 }
                 
-                const dataPtr = Module._malloc(dataBytes.length), keyPtr = Module._malloc(keyBytes.length), outputPtr = Module._malloc(dataBytes.length);
-                if (!dataPtr || !keyPtr || !outputPtr) {
+                const dataPtr = Module._malloc(dataBytes.length), outputPtr = Module._malloc(dataBytes.length);
+                if (!dataPtr || !outputPtr) {
                     alert('Memory allocation failed. Please try again.');
                     if (dataPtr) Module._free(dataPtr);
-                    if (keyPtr) Module._free(keyPtr);
                     if (outputPtr) Module._free(outputPtr);
                     return;
                 }
@@ -180,18 +324,17 @@ document.addEventListener('DOMContentLoaded', () => {
                     // Additional validation
                     if (dataBytes.length === 0) {
                         alert('Invalid input data length.');
-                        Module._free(dataPtr); Module._free(keyPtr); Module._free(outputPtr);
+                        Module._free(dataPtr); Module._free(outputPtr);
             return;
         }
 
                     Module.HEAPU8.set(dataBytes, dataPtr); 
-                    Module.HEAPU8.set(keyBytes, keyPtr);
                     
-                    let success = c_process(dataPtr, dataBytes.length, keyPtr, outputPtr, (action === 'encrypt'));
+                    let success = c_process(ctx, dataPtr, dataBytes.length, 0, MODE_ECB, outputPtr, (action === 'encrypt'));
                     
                     if (!success) {
                         alert(`${algorithm.toUpperCase()} processing failed. Please check your input and try again.`);
-                        Module._free(dataPtr); Module._free(keyPtr); Module._free(outputPtr);
+                        Module._free(dataPtr); Module._free(outputPtr);
                 return;
             }
 
@@ -200,11 +343,11 @@ document.addEventListener('DOMContentLoaded', () => {
                     // Validate result
                     if (!resultBytes || resultBytes.length === 0) {
                         alert('Invalid output from encryption/decryption.');
-                        Module._free(dataPtr); Module._free(keyPtr); Module._free(outputPtr);
+                        Module._free(dataPtr); Module._free(outputPtr);
                 return;
             }
             
-                    Module._free(dataPtr); Module._free(keyPtr); Module._free(outputPtr);
+                    Module._free(dataPtr); Module._free(outputPtr);
                     
             if (action === 'encrypt') {
                         result = btoa(String.fromCharCode.apply(null, resultBytes));
@@ -221,7 +364,6 @@ document.addEventListener('DOMContentLoaded', () => {
                     // Ensure cleanup even if there's an error
                     try {
                         Module._free(dataPtr); 
-                        Module._free(keyPtr); 
                         Module._free(outputPtr);
                     } catch (cleanupError) {
                         console.error('Cleanup error:', cleanupError);
@@ -231,10 +373,30 @@ document.addEventListener('DOMContentLoaded', () => {
             } else if (algorithm === 'rsa') {
                 const n = document.getElementById('rsa-n').value, e = document.getElementById('rsa-e').value, d = document.getElementById('rsa-d').value;
                 if (!n || !e || (action === 'decrypt' && !d)) { alert('For RSA, please generate or provide n, e, and d values.'); return; }
-                if (isNaN(n) || isNaN(e) || (action === 'decrypt' && isNaN(d))) { alert('Invalid key: RSA keys must be numbers.'); return; }
-                const c_process_rsa = Module.cwrap('process_rsa', 'string', ['string', 'number', 'number']);
-                if (action === 'encrypt') result = c_process_rsa(text, BigInt(n), -BigInt(e));
-                else result = c_process_rsa(text, BigInt(n), BigInt(d));
+                if (!/^\d+$/.test(n) || !/^\d+$/.test(e) || (action === 'decrypt' && !/^\d+$/.test(d))) { alert('Invalid key: RSA keys must be numbers.'); return; }
+                const privateKey = (rsaCrtKey && rsaCrtKey.n === n && rsaCrtKey.d === d) ? rsaCrtKey.crt : d;
+                if (action === 'decrypt' && /^[\d,\s]+$/.test(text)) {
+                    // Comma-separated decimal ciphertext from the older per-character format
+                    const c_process_rsa = Module.cwrap('process_rsa', 'string', ['string', 'string', 'string', 'number']);
+                    result = c_process_rsa(text, n, privateKey, 0);
+                } else if (action === 'encrypt' && Module.cwrap('rsa_encrypted_size', 'number', ['string', 'number', 'number'])(n, 0, RSA_PADDING_PKCS1) < 0) {
+                    // Toy moduli below 96 bits cannot hold a padded block
+                    const c_process_rsa = Module.cwrap('process_rsa', 'string', ['string', 'string', 'string', 'number']);
+                    result = c_process_rsa(text, n, e, 1);
+                } else if (action === 'encrypt') {
+                    const resultBytes = rsaProcessBytes(Module, new TextEncoder().encode(text), n, e, true);
+                    if (!resultBytes) { alert('RSA encryption failed. Please check the key and try again.'); return; }
+                    let binary = '';
+                    for (const b of resultBytes) binary += String.fromCharCode(b);
+                    result = btoa(binary);
+                } else {
+                    let dataBytes;
+                    try { dataBytes = Uint8Array.from(atob(text.trim()), c => c.charCodeAt(0)); }
+                    catch (err) { alert('Invalid Base64 input for decryption.'); return; }
+                    const resultBytes = rsaProcessBytes(Module, dataBytes, n, privateKey, false);
+                    if (!resultBytes) { alert('RSA decryption failed. Please check the key and ciphertext.'); return; }
+                    result = new TextDecoder().decode(resultBytes);
+                }
             } else if (algorithm === 'ecies') {
                 if (action === 'encrypt') {
                     const pubKeyStr = document.getElementById('ecies-pub').value;
@@ -284,24 +446,124 @@ document.addEventListener('DOMContentLoaded', () => {
     }
     
     // --- Key Generation and Exchange Handlers ---
-    async function generateRsaKeys() { try { const Module = await loadWasmModule('rsa'); const c_generate_keys = Module.cwrap('generate_keys', 'string', []); const keys = c_generate_keys().split(','); const [n_val, e_val, d_val] = keys; document.getElementById('rsa-n').value = n_val; document.getElementById('rsa-e').value = e_val; document.getElementById('rsa-d').value = d_val; document.getElementById('rsa-public-key').value = `(${e_val}, ${n_val})`; document.getElementById('rsa-private-key').value = `(${d_val}, ${n_val})`; } catch (e) { console.error("Error generating RSA keys:", e); } }
+    // CRT components of the last generated RSA key, used while d is unchanged
+    let rsaCrtKey = null;
+    async function generateRsaKeys() { try { const Module = await loadWasmModule('rsa'); const c_generate_keys = Module.cwrap('generate_keys', 'string', ['number']); const bits = parseInt(document.getElementById('rsa-bits').value, 10); const keys = c_generate_keys(bits).split(','); const [n_val, e_val, d_val, p_val, q_val, dp_val, dq_val, qinv_val] = keys; rsaCrtKey = { n: n_val, d: d_val, crt: [d_val, p_val, q_val, dp_val, dq_val, qinv_val].join(',') }; document.getElementById('rsa-n').value = n_val; document.getElementById('rsa-e').value = e_val; document.getElementById('rsa-d').value = d_val; document.getElementById('rsa-public-key').value = `(${e_val}, ${n_val})`; document.getElementById('rsa-private-key').value = `(${d_val}, ${n_val}; p=${p_val}, q=${q_val}, dP=${dp_val}, dQ=${dq_val}, qInv=${qinv_val})`; } catch (e) { console.error("Error generating RSA keys:", e); } }
+    // Factors n with rsa_factor_step() in short slices so the page stays responsive; a second click stops it
+    const FACTOR_RUNNING = 1, FACTOR_FOUND = 2, FACTOR_PRIME = 3;
+    let factorSearch = null;
+    async function factorRsaModulus() {
+        const button = document.getElementById('factor-rsa-btn'), output = document.getElementById('rsa-factor-result');
+        if (factorSearch) { factorSearch.stop = true; return; }
+        const n = document.getElementById('rsa-n').value.trim();
+        if (!/^\d+$/.test(n)) { alert('Invalid key: RSA modulus must be a number.'); return; }
+        const Module = await loadWasmModule('rsa');
+        const c_create = Module.cwrap('rsa_factor_create', 'number', ['string']);
+        const c_step = Module.cwrap('rsa_factor_step', 'number', ['number', 'number']);
+        const c_status = Module.cwrap('rsa_factor_status', 'number', ['number', 'number']);
+        const c_result = Module.cwrap('rsa_factor_result', 'string', ['number']);
+        const c_destroy = Module.cwrap('rsa_factor_destroy', 'number', ['number']);
+        const handle = c_create(n);
+        if (!handle) { alert('Factoring supports moduli from 4 up to 256 bits.'); return; }
+        const statsPtr = Module._malloc(6 * 8);
+        factorSearch = { stop: false };
+        button.textContent = 'Stop';
+        try {
+            let state = FACTOR_RUNNING;
+            while (state === FACTOR_RUNNING && !factorSearch.stop) {
+                state = c_step(handle, 0.1);
+                c_status(handle, statsPtr);
+                const [rhoSteps, rhoRate, curves, curveRate, b1, seconds] = Module.HEAPF64.subarray(statsPtr / 8, statsPtr / 8 + 6);
+                output.value = `${seconds.toFixed(2)} s: rho ${Math.round(rhoSteps)} steps (${(rhoRate / 1e6).toFixed(2)}M/s), ECM ${curves} curves (${curveRate.toFixed(1)}/s, B1=${b1})`;
+                await new Promise(resolve => setTimeout(resolve, 0));
+            }
+            const seconds = Module.HEAPF64[statsPtr / 8 + 5];
+            if (state === FACTOR_FOUND) { const [p, q, method] = c_result(handle).split(','); output.value = `n = ${p} \u00d7 ${q} (${method}, ${seconds.toFixed(3)} s)`; }
+            else if (state === FACTOR_PRIME) output.value = 'n is prime';
+            else output.value += ' (stopped)';
+        } finally {
+            Module._free(statsPtr); c_destroy(handle);
+            factorSearch = null; button.textContent = 'Factor n';
+        }
+    }
+    // Recovers the DES key from one known block with des_key_search_step() in
+    // short slices, the low bits of the key treated as unknown; a second click stops it
+    const DES_SEARCH_RUNNING = 1, DES_SEARCH_FOUND = 2;
+    let desSearch = null;
+    async function searchDesKey() {
+        const button = document.getElementById('des-search-btn'), output = document.getElementById('des-search-result');
+        if (desSearch) { desSearch.stop = true; return; }
+        const key = keyInputSymm.value;
+        if (key.length !== 8) { alert('Invalid key: DES key must be exactly 8 characters long.'); return; }
+        const Module = await loadWasmModule('des');
+        const c_process = Module.cwrap('process_des', 'number', ['number', 'number', 'number', 'number', 'boolean']);
+        const c_create = Module.cwrap('des_key_search_create', 'number', ['number', 'number', 'number', 'number']);
+        const c_step = Module.cwrap('des_key_search_step', 'number', ['number', 'number']);
+        const c_status = Module.cwrap('des_key_search_status', 'number', ['number', 'number', 'number']);
+        const c_destroy = Module.cwrap('des_key_search_destroy', 'number', ['number']);
+
+        // Buffers: plaintext, ciphertext, key, mask, found key, then 4 stats doubles
+        const bufPtr = Module._malloc(40 + 4 * 8);
+        if (!bufPtr) { alert('Memory allocation failed. Please try again.'); return; }
+        const statsPtr = bufPtr + 40;
+        let bits = parseInt(document.getElementById('des-search-bits').value, 10);
+        const mask = new Uint8Array(8);
+        for (let i = 7; i >= 0; i--) { const take = Math.min(bits, 7); mask[i] = ((1 << take) - 1) << 1; bits -= take; }
+        Module.HEAPU8.set(crypto.getRandomValues(new Uint8Array(8)), bufPtr);
+        Module.HEAPU8.set(new TextEncoder().encode(key), bufPtr + 16);
+        Module.HEAPU8.set(mask, bufPtr + 24);
+        const handle = c_process(bufPtr, 8, bufPtr + 16, bufPtr + 8, true) ? c_create(bufPtr, bufPtr + 8, bufPtr + 16, bufPtr + 24) : 0;
+        if (!handle) { Module._free(bufPtr); alert('DES key search setup failed.'); return; }
+        desSearch = { stop: false };
+        button.textContent = 'Stop';
+        try {
+            let state = DES_SEARCH_RUNNING;
+            while (state === DES_SEARCH_RUNNING && !desSearch.stop) {
+                state = c_step(handle, 1 << 22);
+                c_status(handle, statsPtr, bufPtr + 32);
+                const [tested, space, rate, seconds] = Module.HEAPF64.subarray(statsPtr / 8, statsPtr / 8 + 4);
+                output.value = `${seconds.toFixed(2)} s: ${Math.round(tested)} of ${space} keys (${(100 * tested / space).toFixed(1)}%), ${(rate / 1e6).toFixed(2)}M keys/s`;
+                await new Promise(resolve => setTimeout(resolve, 0));
+            }
+            if (state === DES_SEARCH_FOUND) {
+                output.value += ` \u2014 key found: "${new TextDecoder().decode(Module.HEAPU8.slice(bufPtr + 32, bufPtr + 40))}"`;
+            } else if (state !== DES_SEARCH_RUNNING) output.value += ' \u2014 key not in the searched space';
+            else output.value += ' (stopped)';
+        } finally {
+            Module.HEAPU8.fill(0, bufPtr, bufPtr + 40);
+            Module._free(bufPtr); c_destroy(handle);
+            desSearch = null; button.textContent = 'Recover Key by Search';
+        }
+    }
     async function generateEciesKeys() { try { const Module = await loadWasmModule('ecc'); const c_generate_keys = Module.cwrap('generate_ecc_keys', 'string', []); const keys = c_generate_keys().split(','); const [priv_val, pub_x, pub_y] = keys; document.getElementById('ecies-priv').value = priv_val; document.getElementById('ecies-pub').value = `(${pub_x}, ${pub_y})`; } catch (e) { console.error("Error generating ECIES keys:", e); } }
-    async function generateDhPublicKey(party) { try { const Module = await loadWasmModule('dh'); const c_generate_key = Module.cwrap('generate_dh_public_key', 'number', ['number', 'number', 'number']); const randomPrivateKey = Math.floor(Math.random() * 200) + 50; const privKeyInput = document.getElementById(`dh-priv-${party}`); privKeyInput.value = randomPrivateKey; const p = BigInt(document.getElementById('dh-p').value), g = BigInt(document.getElementById('dh-g').value), privKey = BigInt(randomPrivateKey); document.getElementById(`dh-pub-${party}`).value = c_generate_key(g, p, privKey); } catch (e) { console.error("Error generating DH public key:", e); } }
-    async function calculateDhSharedSecret() { try { const Module = await loadWasmModule('dh'); const c_calculate_secret = Module.cwrap('calculate_dh_shared_secret', 'number', ['number', 'number', 'number']); const p = BigInt(document.getElementById('dh-p').value), privA = BigInt(document.getElementById('dh-priv-a').value), pubB = BigInt(document.getElementById('dh-pub-b').value), privB = BigInt(document.getElementById('dh-priv-b').value), pubA = BigInt(document.getElementById('dh-pub-a').value); if (!pubA || !pubB) { alert("Please generate public keys for both parties first."); return; } document.getElementById('dh-secret-a').value = c_calculate_secret(pubB, p, privA); document.getElementById('dh-secret-b').value = c_calculate_secret(pubA, p, privB); } catch (e) { console.error("Error calculating DH shared secret:", e); } }
+    // Random private exponent for DH: 256 bits from the browser CSPRNG, as 0x-prefixed hex
+    function randomDhPrivateKey() { const bytes = crypto.getRandomValues(new Uint8Array(32)); return '0x' + Array.from(bytes, b => b.toString(16).padStart(2, '0')).join(''); }
+    async function generateDhPublicKey(party) { try { const Module = await loadWasmModule('dh'); const c_generate_key = Module.cwrap('dh_public_key', 'string', ['string', 'string', 'string']); const privKeyInput = document.getElementById(`dh-priv-${party}`); if (!privKeyInput.value) privKeyInput.value = randomDhPrivateKey(); const p = document.getElementById('dh-p').value.trim(), g = document.getElementById('dh-g').value.trim(); const pubKey = c_generate_key(g, p, privKeyInput.value.trim()); if (!pubKey) { alert("Invalid DH parameters: p, g and the private key must be numbers."); return; } document.getElementById(`dh-pub-${party}`).value = pubKey; } catch (e) { console.error("Error generating DH public key:", e); } }
+    async function calculateDhSharedSecret() { try { const Module = await loadWasmModule('dh'); const c_calculate_secret = Module.cwrap('dh_shared_secret', 'string', ['string', 'string', 'string']); const p = document.getElementById('dh-p').value.trim(), privA = document.getElementById('dh-priv-a').value.trim(), pubB = document.getElementById('dh-pub-b').value, privB = document.getElementById('dh-priv-b').value.trim(), pubA = document.getElementById('dh-pub-a').value; if (!pubA || !pubB) { alert("Please generate public keys for both parties first."); return; } document.getElementById('dh-secret-a').value = c_calculate_secret(pubB, p, privA); document.getElementById('dh-secret-b').value = c_calculate_secret(pubA, p, privB); } catch (e) { console.error("Error calculating DH shared secret:", e); } }
     async function generateEcdhKeys(party) { try { const Module = await loadWasmModule('ecc'); const c_generate_keys = Module.cwrap('generate_ecc_keys', 'string', []); const keys = c_generate_keys().split(','); document.getElementById(`ecdh-priv-${party}`).value = keys[0]; document.getElementById(`ecdh-pub-${party}`).value = `(${keys[1]}, ${keys[2]})`; } catch (e) { console.error("Error generating ECDH keys:", e); } }
     async function calculateEcdhSharedSecret() { try { const Module = await loadWasmModule('ecc'); const c_calculate_secret = Module.cwrap('calculate_shared_secret', 'string', ['number', 'number', 'number']); const privA = BigInt(document.getElementById('ecdh-priv-a').value), pubB_str = document.getElementById('ecdh-pub-b').value.replace(/[() ]/g, '').split(','), privB = BigInt(document.getElementById('ecdh-priv-b').value), pubA_str = document.getElementById('ecdh-pub-a').value.replace(/[() ]/g, '').split(','); if (pubA_str.length < 2 || pubB_str.length < 2) { alert("Please generate keys for both parties first."); return; } document.getElementById('ecdh-secret-a').value = c_calculate_secret(privA, BigInt(pubB_str[0]), BigInt(pubB_str[1])); document.getElementById('ecdh-secret-b').value = c_calculate_secret(privB, BigInt(pubA_str[0]), BigInt(pubA_str[1])); } catch (e) { console.error("Error calculating ECDH shared secret:", e); } }
 
     // --- Event Listeners ---
     cryptoTypeRadios.forEach(radio => { radio.addEventListener('change', () => { const type = radio.value; symmetricControls.style.display = (type === 'symmetric') ? 'block' : 'none'; asymmetricControls.style.display = (type === 'asymmetric') ? 'block' : 'none'; keyExchangeControls.style.display = (type === 'key-exchange') ? 'block' : 'none'; updatePanels(); loadWasmModule(getCurrentAlgorithm()).catch(err => console.error(err)); }); });
     [symmetricAlgoSelect, asymmetricAlgoSelect, keyExchangeAlgoSelect].forEach(select => { select.addEventListener('change', () => { updatePanels(); loadWasmModule(getCurrentAlgorithm()).catch(err => console.error(err)); }); });
+    // X25519 keys and secrets cross the WASM boundary as 32-byte buffers and are shown as hex
+    const bytesToHex = bytes => Array.from(bytes, b => b.toString(16).padStart(2, '0')).join('');
+    const hexToBytes = hex => Uint8Array.from(hex.match(/../g) || [], h => parseInt(h, 16));
+    async function generateX25519Keys(party) { try { const Module = await loadWasmModule('ecc'); const bufPtr = Module._malloc(64); try { if (!Module.cwrap('x25519_generate_keys', 'number', ['number', 'number'])(bufPtr, bufPtr + 32)) { alert("X25519 key generation failed."); return; } document.getElementById(`x25519-priv-${party}`).value = bytesToHex(Module.HEAPU8.subarray(bufPtr, bufPtr + 32)); document.getElementById(`x25519-pub-${party}`).value = bytesToHex(Module.HEAPU8.subarray(bufPtr + 32, bufPtr + 64)); } finally { Module.HEAPU8.fill(0, bufPtr, bufPtr + 64); Module._free(bufPtr); } } catch (e) { console.error("Error generating X25519 keys:", e); } }
+    function x25519Secret(Module, privHex, pubHex) { const bufPtr = Module._malloc(96); try { Module.HEAPU8.set(hexToBytes(privHex), bufPtr + 32); Module.HEAPU8.set(hexToBytes(pubHex), bufPtr + 64); const ok = Module.cwrap('x25519_shared_secret', 'number', ['number', 'number', 'number'])(bufPtr, bufPtr + 32, bufPtr + 64); return ok ? bytesToHex(Module.HEAPU8.subarray(bufPtr, bufPtr + 32)) : 'Error: invalid public key'; } finally { Module.HEAPU8.fill(0, bufPtr, bufPtr + 96); Module._free(bufPtr); } }
+    async function calculateX25519SharedSecret() { try { const Module = await loadWasmModule('ecc'); const privA = document.getElementById('x25519-priv-a').value, pubA = document.getElementById('x25519-pub-a').value, privB = document.getElementById('x25519-priv-b').value, pubB = document.getElementById('x25519-pub-b').value; if (pubA.length !== 64 || pubB.length !== 64) { alert("Please generate X25519 keys for both parties first."); return; } document.getElementById('x25519-secret-a').value = x25519Secret(Module, privA, pubB); document.getElementById('x25519-secret-b').value = x25519Secret(Module, privB, pubA); } catch (e) { console.error("Error calculating X25519 shared secret:", e); } }
     document.querySelectorAll('.encrypt-btn').forEach(btn => btn.addEventListener('click', () => handleCryptoAction('encrypt')));
     document.querySelectorAll('.decrypt-btn').forEach(btn => btn.addEventListener('click', () => handleCryptoAction('decrypt')));
     document.getElementById('generate-rsa-btn').addEventListener('click', generateRsaKeys);
+    document.getElementById('factor-rsa-btn').addEventListener('click', factorRsaModulus);
+    document.getElementById('des-search-btn').addEventListener('click', searchDesKey);
     document.getElementById('generate-ecies-btn').addEventListener('click', generateEciesKeys);
     document.querySelectorAll('.generate-dh-btn').forEach(btn => btn.addEventListener('click', (e) => generateDhPublicKey(e.target.dataset.party)));
     document.getElementById('calculate-dh-secret-btn').addEventListener('click', calculateDhSharedSecret);
     document.querySelectorAll('.generate-ecdh-btn').forEach(btn => btn.addEventListener('click', (e) => generateEcdhKeys(e.target.dataset.party)));
     document.getElementById('calculate-ecdh-secret-btn').addEventListener('click', calculateEcdhSharedSecret);
+    document.querySelectorAll('.generate-x25519-btn').forEach(btn => btn.addEventListener('click', (e) => generateX25519Keys(e.target.dataset.party)));
+    document.getElementById('calculate-x25519-secret-btn').addEventListener('click', calculateX25519SharedSecret);
 
     // Add CSS for ripple animation
     const style = document.createElement('style');
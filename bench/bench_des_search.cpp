@@ -0,0 +1,83 @@
+// bench/bench_des_search.cpp
+// Native benchmark for the des_key_search_*() exports: known-plaintext
+// searches over 16- to 32-bit masks of a random key, with keys per second
+// and how much of the space was covered before the key turned up. Also
+// checks that a huge max_keys still tests keys. Built by build_native.sh;
+// the first argument is the widest mask in bits (default 32).
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+#include "../crypto_src/DES/des.cpp"
+
+// Keys per des_key_search_step() call, as the page's slices do
+#define BENCH_STEP_KEYS (1 << 24)
+
+// Mask with the lowest `bits` non-parity key bits unknown
+static void lowMask(int bits, uint8_t* mask) {
+    for (int i = 7; i >= 0; i--) {
+        int take = (bits > 7) ? 7 : bits;
+        mask[i] = (uint8_t)(((1 << take) - 1) << 1);
+        bits -= take;
+    }
+}
+
+static bool sameKey(const uint8_t* a, const uint8_t* b) {
+    for (int i = 0; i < 8; i++) {
+        if ((a[i] & 0xfe) != (b[i] & 0xfe)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int maxBits = (argc > 1) ? atoi(argv[1]) : 32;
+    std::mt19937_64 rng(std::random_device{}());
+    bool ok = true;
+    uint8_t plaintext[8], ciphertext[8], key[8], mask[8], found[8];
+    double stats[4];
+
+    // A full 56-bit mask whose key is the first candidate: one step with a
+    // max_keys far past what an int of work items covers must find it
+    for (int i = 0; i < 8; i++) {
+        plaintext[i] = (uint8_t)rng();
+        key[i] = 0x01;
+    }
+    lowMask(56, mask);
+    process_des(plaintext, 8, key, ciphertext, true);
+    DesKeySearch* s = des_key_search_create(plaintext, ciphertext, key, mask);
+    int state = des_key_search_step(s, 1e18);
+    des_key_search_status(s, stats, found);
+    des_key_search_destroy(s);
+    bool large = state == DES_SEARCH_FOUND && stats[0] > 0 && sameKey(found, key);
+    printf("%-28s %s\n", "max_keys 1e18, 56-bit mask", large ? "ok" : "FAILED");
+    ok &= large;
+
+    bool tty = isatty(fileno(stdout));
+    printf("%d thread(s)\n", parallelThreads());
+    printf("%5s %14s %8s %10s %14s\n", "bits", "keys tested", "of space", "seconds", "keys/s");
+    for (int bits = 16; bits <= maxBits; bits += 4) {
+        for (int i = 0; i < 8; i++) {
+            plaintext[i] = (uint8_t)rng();
+            key[i] = (uint8_t)rng();
+        }
+        lowMask(bits, mask);
+        process_des(plaintext, 8, key, ciphertext, true);
+
+        s = des_key_search_create(plaintext, ciphertext, key, mask);
+        while ((state = des_key_search_step(s, BENCH_STEP_KEYS)) == DES_SEARCH_RUNNING) {
+            if (!tty) continue;
+            des_key_search_status(s, stats, 0);
+            printf("\r%5d %14.0f %7.1f%%", bits, stats[0], 100 * stats[0] / stats[1]);
+            fflush(stdout);
+        }
+        des_key_search_status(s, stats, found);
+        des_key_search_destroy(s);
+        if (state != DES_SEARCH_FOUND || !sameKey(found, key)) {
+            printf("\r%5d bits: key not found\n", bits);
+            ok = false;
+            continue;
+        }
+        printf("\r%5d %14.0f %7.1f%% %10.3f %14.0f\n", bits, stats[0], 100 * stats[0] / stats[1], stats[3], stats[2]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+// bench/bench_factor.cpp
+// Native factoring benchmark for the rsa_factor_*() exports: wall-clock time
+// to split RSA moduli from 32 to 128 bits, each the product of two random
+// primes of half the size as generate_keys() makes them. Built by
+// build_native.sh; the first argument is the moduli per size (default 3).
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../crypto_src/RSA/rsa.cpp"
+
+int main(int argc, char** argv) {
+    int trials = (argc > 1) ? atoi(argv[1]) : 3;
+    printf("%d thread(s), %d moduli per size\n", parallelThreads(), trials);
+    printf("%5s %12s %12s %8s %14s %12s\n", "bits", "median s", "max s", "method", "rho steps/s", "curves/s");
+    for (int bits = 32; bits <= 128; bits += 16) {
+        std::vector<double> times;
+        std::string methods;
+        double rhoRate = 0, curveRate = 0;
+        for (int t = 0; t < trials; t++) {
+            const char* keys = generate_keys(bits);
+            std::string n(keys, strchr(keys, ',') - keys);
+            free((void*)keys);
+
+            FactorSearch* s = rsa_factor_create(n.c_str());
+            while (rsa_factor_step(s, 1.0) == FACTOR_RUNNING) {}
+            double stats[6];
+            rsa_factor_status(s, stats);
+            const char* result = rsa_factor_result(s);
+            std::string split(result ? result : "");
+            free((void*)result);
+            rsa_factor_destroy(s);
+
+            // Check p * q == n
+            size_t c1 = split.find(','), c2 = split.find(',', c1 + 1);
+            BigInt p, q, pq, nBig;
+            bigFromString(split.substr(0, c1).c_str(), p);
+            bigFromString(split.substr(c1 + 1, c2 - c1 - 1).c_str(), q);
+            bigFromString(n.c_str(), nBig);
+            bigMul(p, q, pq);
+            if (bigCompare(pq, nBig) != 0 || bigBitLength(p) < 2) {
+                printf("bad split of %s: %s\n", n.c_str(), split.c_str());
+                return 1;
+            }
+
+            times.push_back(stats[5]);
+            std::string method = split.substr(c2 + 1);
+            if (methods.find(method) == std::string::npos) methods += (methods.empty() ? "" : "/") + method;
+            rhoRate = std::max(rhoRate, stats[1]);
+            curveRate = std::max(curveRate, stats[3]);
+        }
+        std::sort(times.begin(), times.end());
+        printf("%5d %12.4f %12.4f %8s %14.0f %12.1f\n", bits, times[times.size() / 2], times.back(), methods.c_str(),
+               rhoRate, curveRate);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// bench/bench_x25519.cpp
+// Native X25519 benchmark for the x25519_*() exports in ECC/ecc.cpp: checks
+// the RFC 7748 test vectors (section 5.2 and the section 6.1 exchange),
+// then reports shared-secret derivations per second on one core. Built by
+// build_native.sh; the first argument is the seconds to time (default 1).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../crypto_src/ECC/ecc.cpp"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (int i = 0; i < 32; i++) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+static bool expect(const char* name, const uint8_t* got, const char* hex) {
+    uint8_t want[32];
+    fromHex(hex, want);
+    bool ok = memcmp(got, want, 32) == 0;
+    printf("%-28s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 1.0;
+    bool ok = true;
+    uint8_t k[32], u[32], out[32];
+
+    // Section 5.2: single multiplications
+    fromHex("a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4", k);
+    fromHex("e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c", u);
+    x25519_shared_secret(out, k, u);
+    ok &= expect("5.2 vector 1", out, "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552");
+    fromHex("4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d", k);
+    fromHex("e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493", u);
+    x25519_shared_secret(out, k, u);
+    ok &= expect("5.2 vector 2", out, "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957");
+
+    // Section 5.2: k, u = X25519(k, u), k iterated 1 and 1000 times
+    uint8_t next[32];
+    memset(k, 0, 32);
+    memset(u, 0, 32);
+    k[0] = u[0] = 9;
+    for (int i = 1; i <= 1000; i++) {
+        x25519ScalarMult(next, k, u);
+        memcpy(u, k, 32);
+        memcpy(k, next, 32);
+        if (i == 1) ok &= expect("5.2 after 1 iteration", k, "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079");
+    }
+    ok &= expect("5.2 after 1000 iterations", k, "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51");
+
+    // Section 6.1: Alice and Bob
+    uint8_t alicePriv[32], alicePub[32], bobPriv[32], bobPub[32], secretA[32], secretB[32];
+    fromHex("77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a", alicePriv);
+    fromHex("5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb", bobPriv);
+    x25519_public_key(alicePub, alicePriv);
+    x25519_public_key(bobPub, bobPriv);
+    ok &= expect("6.1 Alice public key", alicePub, "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a");
+    ok &= expect("6.1 Bob public key", bobPub, "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f");
+    x25519_shared_secret(secretA, alicePriv, bobPub);
+    x25519_shared_secret(secretB, bobPriv, alicePub);
+    ok &= expect("6.1 shared secret (Alice)", secretA, "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742");
+    ok &= expect("6.1 shared secret (Bob)", secretB, "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742");
+
+    // A small-order peer key (u = 0) must be refused
+    memset(u, 0, 32);
+    bool refused = x25519_shared_secret(out, alicePriv, u) == 0;
+    printf("%-28s %s\n", "zero shared secret refused", refused ? "ok" : "FAILED");
+    ok &= refused;
+
+    int count = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        x25519_shared_secret(out, alicePriv, bobPub);
+        alicePriv[count & 31] ^= out[0];
+        count++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    printf("%.1f us per shared secret, %.0f per second\n", 1e6 * elapsed / count, count / elapsed);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+# Native (non-emscripten) builds of the crypto modules as shared libraries.
+# The C exports match the WASM modules; x86-64 builds pick AES-NI at runtime.
+CXX=${CXX:-g++}
+mkdir -p build/native
+
+echo "--- Building Native Symmetric Ciphers ---"
+$CXX -std=c++17 -O3 -fPIC -shared -pthread crypto_src/AES/aes.cpp -o build/native/libaes.so
+$CXX -std=c++17 -O3 -fPIC -shared -pthread crypto_src/DES/des.cpp -o build/native/libdes.so
+
+echo "--- Building Native Asymmetric Ciphers ---"
+$CXX -std=c++17 -O3 -fPIC -shared -pthread crypto_src/RSA/rsa.cpp -o build/native/librsa.so
+$CXX -std=c++17 -O3 -fPIC -shared crypto_src/ECIES/ecies.cpp -o build/native/libecies.so
+
+echo "--- Building Native Key Exchange Protocols ---"
+$CXX -std=c++17 -O3 -fPIC -shared crypto_src/DH/diffie_hellman.cpp -o build/native/libdh.so
+$CXX -std=c++17 -O3 -fPIC -shared crypto_src/ECC/ecc.cpp -o build/native/libecc.so
+
+echo "--- Building Native Benchmarks ---"
+$CXX -std=c++17 -O3 -pthread bench/bench_modes.cpp -o build/native/bench_modes
+$CXX -std=c++17 -O3 bench/bench_modexp.cpp -o build/native/bench_modexp
+$CXX -std=c++17 -O3 -pthread bench/bench_factor.cpp -o build/native/bench_factor
+$CXX -std=c++17 -O3 -pthread bench/bench_des_search.cpp -o build/native/bench_des_search
+$CXX -std=c++17 -O3 bench/bench_x25519.cpp -o build/native/bench_x25519
+
+echo "--- Native modules built in build/native ---"
@@ -2,17 +2,23 @@
 
 echo "--- Building Symmetric Ciphers ---"
 emcc crypto_src/RailFence/railfence.cpp -o app/static/wasm/railfence.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_encrypt", "_decrypt"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
-emcc crypto_src/AES/aes.cpp -o app/static/wasm/aes.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_aes", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8"]'
-emcc crypto_src/DES/des.cpp -o app/static/wasm/des.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_des", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8"]'
+emcc crypto_src/AES/aes.cpp -o app/static/wasm/aes.js -std=c++17 -O3 -msimd128 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_aes", "_process_aes_keylen", "_process_aes_gcm", "_aes_ctr_init", "_aes_ctr_update", "_aes_ctr_final", "_process_aes_xts", "_process_aes_xts_batch", "_process_aes_mode", "_aes_create_context", "_aes_context_process", "_aes_destroy_context", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8"]'
+emcc crypto_src/AES/aes.cpp -o app/static/wasm/aes_mt.js -std=c++17 -O3 -msimd128 -pthread -sPTHREAD_POOL_SIZE=4 -sALLOW_MEMORY_GROWTH=1 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_aes", "_process_aes_keylen", "_process_aes_gcm", "_aes_ctr_init", "_aes_ctr_update", "_aes_ctr_final", "_process_aes_xts", "_process_aes_xts_batch", "_process_aes_mode", "_aes_create_context", "_aes_context_process", "_aes_destroy_context", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8"]'
+emcc crypto_src/DES/des.cpp -o app/static/wasm/des.js -std=c++17 -O3 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_des", "_process_des_mode", "_des_create_context", "_des_context_process", "_des_destroy_context", "_process_3des", "_process_3des_mode", "_tdes_create_context", "_tdes_context_process", "_tdes_destroy_context", "_des_key_search_create", "_des_key_search_step", "_des_key_search_status", "_des_key_search_destroy", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8", "HEAPF64"]'
+emcc crypto_src/DES/des.cpp -o app/static/wasm/des_mt.js -std=c++17 -O3 -pthread -sPTHREAD_POOL_SIZE=4 -sALLOW_MEMORY_GROWTH=1 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_process_des", "_process_des_mode", "_des_create_context", "_des_context_process", "_des_destroy_context", "_process_3des", "_process_3des_mode", "_tdes_create_context", "_tdes_context_process", "_tdes_destroy_context", "_des_key_search_create", "_des_key_search_step", "_des_key_search_status", "_des_key_search_destroy", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8", "HEAPF64"]'
 emcc crypto_src/Vigenere/vigenere.cpp -o app/static/wasm/vigenere.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_encrypt", "_decrypt", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
 emcc crypto_src/Playfair/playfair.cpp -o app/static/wasm/playfair.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_encrypt", "_decrypt", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
 
 echo "--- Building Asymmetric Ciphers ---"
-emcc crypto_src/RSA/rsa.cpp -o app/static/wasm/rsa.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_keys", "_process_rsa", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
+# RSA key generation nests about 60 KB of stack (generate_keys, the prime
+# sieve, then Miller-Rabin with its window table), and pool threads run the
+# Miller-Rabin part, so both stacks are raised above emscripten's 64 KB.
+emcc crypto_src/RSA/rsa.cpp -o app/static/wasm/rsa.js -std=c++17 -O3 -sSTACK_SIZE=512KB -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_keys", "_process_rsa", "_rsa_encrypted_size", "_rsa_encrypt", "_rsa_decrypt", "_rsa_create_key", "_rsa_destroy_key", "_rsa_batch_size", "_rsa_batch_process", "_rsa_factor_create", "_rsa_factor_step", "_rsa_factor_status", "_rsa_factor_result", "_rsa_factor_destroy", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8", "HEAPF64"]'
+emcc crypto_src/RSA/rsa.cpp -o app/static/wasm/rsa_mt.js -std=c++17 -O3 -pthread -sPTHREAD_POOL_SIZE=4 -sSTACK_SIZE=512KB -sDEFAULT_PTHREAD_STACK_SIZE=256KB -sALLOW_MEMORY_GROWTH=1 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_keys", "_process_rsa", "_rsa_encrypted_size", "_rsa_encrypt", "_rsa_decrypt", "_rsa_create_key", "_rsa_destroy_key", "_rsa_batch_size", "_rsa_batch_process", "_rsa_factor_create", "_rsa_factor_step", "_rsa_factor_status", "_rsa_factor_result", "_rsa_factor_destroy", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8", "HEAPF64"]'
 emcc crypto_src/ECIES/ecies.cpp -o app/static/wasm/ecies.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_encrypt_ecies", "_decrypt_ecies", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
 
 echo "--- Building Key Exchange Protocols ---"
-emcc crypto_src/DH/diffie_hellman.cpp -o app/static/wasm/dh.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_dh_public_key", "_calculate_dh_shared_secret"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
-emcc crypto_src/ECC/ecc.cpp -o app/static/wasm/ecc.js -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_ecc_keys", "_calculate_shared_secret", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
+emcc crypto_src/DH/diffie_hellman.cpp -o app/static/wasm/dh.js -std=c++17 -O3 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_dh_public_key", "_dh_shared_secret", "_generate_dh_public_key", "_calculate_dh_shared_secret"]' -s EXPORTED_RUNTIME_METHODS='["cwrap"]'
+emcc crypto_src/ECC/ecc.cpp -o app/static/wasm/ecc.js -std=c++17 -O3 -s WASM=1 -sMODULARIZE=1 -sEXPORT_ES6=1 -s EXPORTED_FUNCTIONS='["_generate_ecc_keys", "_calculate_shared_secret", "_x25519_public_key", "_x25519_generate_keys", "_x25519_shared_secret", "_malloc", "_free"]' -s EXPORTED_RUNTIME_METHODS='["cwrap", "HEAPU8"]'
 
 echo "--- All modules built successfully! ---"
\ No newline at end of file
@@ -1,10 +1,28 @@
 // crypto_src/AES/aes.cpp
-// Complete AES-128 ECB implementation based on reference code
+// Complete AES-128/192/256 implementation (ECB, CTR, GCM) based on reference code
+#include <cstddef>
 #include <cstdint>
+#include <new>
+#include <utility>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+#if !defined(__EMSCRIPTEN__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_NATIVE_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include "../Common/block_modes.h"
+#include "../Common/thread_pool.h"
 
 // AES S-box
-static const uint8_t sbox[256] = {
+static constexpr uint8_t sbox[256] = {
     0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
     0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
     0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
@@ -24,7 +42,7 @@ static const uint8_t sbox[256] = {
 };
 
 // AES Inverse S-box
-static const uint8_t rsbox[256] = {
+static constexpr uint8_t rsbox[256] = {
     0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
     0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
     0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
@@ -43,238 +61,1381 @@ static const uint8_t rsbox[256] = {
     0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
 
-// Rcon (Round Constants) - based on reference
-static const uint8_t rcon[256] = {
-    0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a,
-    0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39,
-    0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a,
-    0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8,
-    0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef,
-    0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc,
-    0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b,
-    0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3,
-    0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94,
-    0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
-    0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35,
-    0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f,
-    0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04,
-    0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63,
-    0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd,
-    0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d
+// Rcon (Round Constants): the 10 values used by the AES-128/192/256 key schedules
+static const uint8_t rcon[10] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
 };
 
-// AddRoundKey
-void addRoundKey(uint8_t* input, uint8_t* key) {
-    for (int i = 0; i < 16; i++) {
-        input[i] ^= key[i];
-    }
+// Multiplication by 2 in GF(2^8) modulo the AES polynomial x^8 + x^4 + x^3 + x + 1
+constexpr uint8_t mul2(uint8_t in) {
+    return (uint8_t)((in << 1) ^ ((in & 0x80) ? 0x1b : 0x00));
 }
 
-// SubBytes
-void byteSubstitution(uint8_t* input) {
-    for (int i = 0; i < 16; i++) {
-        input[i] = sbox[input[i]];
+// General multiplication in GF(2^8), only used to build the tables below
+constexpr uint8_t gmul(uint8_t a, uint8_t b) {
+    uint8_t res = 0;
+    while (b) {
+        if (b & 1) res ^= a;
+        a = mul2(a);
+        b >>= 1;
     }
+    return res;
 }
 
-// InvSubBytes
-void invByteSubstitution(uint8_t* input) {
-    for (int i = 0; i < 16; i++) {
-        input[i] = rsbox[input[i]];
+constexpr uint32_t rotr8(uint32_t w) {
+    return (w >> 8) | (w << 24);
+}
+
+// T-tables: each entry combines SubBytes and one MixColumns column, so a full
+// round is four lookups and four XORs per output column. Te/Td[1..3] are the
+// byte rotations of Te/Td[0].
+struct AesTables {
+    uint32_t Te[4][256];
+    uint32_t Td[4][256];
+};
+
+constexpr AesTables makeTables() {
+    AesTables t = {};
+    for (int x = 0; x < 256; x++) {
+        uint8_t s = sbox[x];
+        uint8_t r = rsbox[x];
+        uint32_t te = ((uint32_t)gmul(s, 2) << 24) | ((uint32_t)s << 16) | ((uint32_t)s << 8) | gmul(s, 3);
+        uint32_t td = ((uint32_t)gmul(r, 14) << 24) | ((uint32_t)gmul(r, 9) << 16) | ((uint32_t)gmul(r, 13) << 8) | gmul(r, 11);
+        for (int i = 0; i < 4; i++) {
+            t.Te[i][x] = te;
+            t.Td[i][x] = td;
+            te = rotr8(te);
+            td = rotr8(td);
+        }
     }
+    return t;
 }
 
-// ShiftRows - based on reference implementation
-void shiftRows(uint8_t* input) {
-    uint8_t result[16];
+static constexpr AesTables tables = makeTables();
+static constexpr const uint32_t (&Te0)[256] = tables.Te[0];
+static constexpr const uint32_t (&Te1)[256] = tables.Te[1];
+static constexpr const uint32_t (&Te2)[256] = tables.Te[2];
+static constexpr const uint32_t (&Te3)[256] = tables.Te[3];
+static constexpr const uint32_t (&Td0)[256] = tables.Td[0];
+static constexpr const uint32_t (&Td1)[256] = tables.Td[1];
+static constexpr const uint32_t (&Td2)[256] = tables.Td[2];
+static constexpr const uint32_t (&Td3)[256] = tables.Td[3];
 
-    result[0] = input[0];
-    result[1] = input[5];
-    result[2] = input[10];
-    result[3] = input[15];
+// Big-endian load/store of a state column
+static inline uint32_t loadWord(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
 
-    result[4] = input[4];
-    result[5] = input[9];
-    result[6] = input[14];
-    result[7] = input[3];
+static inline void storeWord(uint8_t* p, uint32_t w) {
+    p[0] = (uint8_t)(w >> 24);
+    p[1] = (uint8_t)(w >> 16);
+    p[2] = (uint8_t)(w >> 8);
+    p[3] = (uint8_t)w;
+}
 
-    result[8] = input[8];
-    result[9] = input[13];
-    result[10] = input[2];
-    result[11] = input[7];
+// The unrolled round sequences below rely on every round being inlined
+#if defined(__GNUC__)
+#define AES_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define AES_FORCE_INLINE inline
+#endif
 
-    result[12] = input[12];
-    result[13] = input[1];
-    result[14] = input[6];
-    result[15] = input[11];
+// Round counts per key size: Nk key words -> Nr = Nk + 6 rounds
+#define AES128_ROUNDS 10
+#define AES192_ROUNDS 12
+#define AES256_ROUNDS 14
+#define AES_MAX_ROUNDS AES256_ROUNDS
 
-    for (int i = 0; i < 16; i++) {
-        input[i] = result[i];
+// SubWord(w) and SubWord(RotWord(w)) for the key schedule
+static inline uint32_t subWord(uint32_t w) {
+    return ((uint32_t)sbox[w >> 24] << 24) | ((uint32_t)sbox[(w >> 16) & 0xff] << 16) |
+           ((uint32_t)sbox[(w >> 8) & 0xff] << 8) | (uint32_t)sbox[w & 0xff];
+}
+
+static inline uint32_t subRotWord(uint32_t w) {
+    return ((uint32_t)sbox[(w >> 16) & 0xff] << 24) | ((uint32_t)sbox[(w >> 8) & 0xff] << 16) |
+           ((uint32_t)sbox[w & 0xff] << 8) | (uint32_t)sbox[w >> 24];
+}
+
+// Key expansion: 4 * Nk-byte key -> 4 * (Nr + 1) round-key words
+template <int Nk>
+void extendKey(const uint8_t* key, uint32_t* roundKeys) {
+    constexpr int words = 4 * (Nk + 6 + 1);
+    for (int i = 0; i < Nk; i++) {
+        roundKeys[i] = loadWord(key + 4 * i);
+    }
+
+    for (int i = Nk; i < words; i++) {
+        uint32_t temp = roundKeys[i - 1];
+        if (i % Nk == 0) {
+            temp = subRotWord(temp) ^ ((uint32_t)rcon[i / Nk - 1] << 24);
+        } else if (Nk > 6 && i % Nk == 4) {
+            temp = subWord(temp);
+        }
+        roundKeys[i] = roundKeys[i - Nk] ^ temp;
     }
 }
 
-// InvShiftRows
-void invShiftRows(uint8_t* input) {
-    uint8_t result[16];
+// Decryption key schedule for the equivalent inverse cipher: round keys in
+// reverse order, with InvMixColumns applied to all but the first and last.
+template <int Nr>
+void extendDecryptionKey(const uint32_t* roundKeys, uint32_t* decKeys) {
+    for (int round = 0; round <= Nr; round++) {
+        for (int j = 0; j < 4; j++) {
+            uint32_t w = roundKeys[4 * (Nr - round) + j];
+            if (round != 0 && round != Nr) {
+                w = Td0[sbox[w >> 24]] ^ Td1[sbox[(w >> 16) & 0xff]] ^
+                    Td2[sbox[(w >> 8) & 0xff]] ^ Td3[sbox[w & 0xff]];
+            }
+            decKeys[4 * round + j] = w;
+        }
+    }
+}
+
+// One T-table round: SubBytes + ShiftRows + MixColumns + AddRoundKey
+static AES_FORCE_INLINE void encryptRound(uint32_t* s, const uint32_t* rk) {
+    uint32_t t0 = Te0[s[0] >> 24] ^ Te1[(s[1] >> 16) & 0xff] ^ Te2[(s[2] >> 8) & 0xff] ^ Te3[s[3] & 0xff] ^ rk[0];
+    uint32_t t1 = Te0[s[1] >> 24] ^ Te1[(s[2] >> 16) & 0xff] ^ Te2[(s[3] >> 8) & 0xff] ^ Te3[s[0] & 0xff] ^ rk[1];
+    uint32_t t2 = Te0[s[2] >> 24] ^ Te1[(s[3] >> 16) & 0xff] ^ Te2[(s[0] >> 8) & 0xff] ^ Te3[s[1] & 0xff] ^ rk[2];
+    uint32_t t3 = Te0[s[3] >> 24] ^ Te1[(s[0] >> 16) & 0xff] ^ Te2[(s[1] >> 8) & 0xff] ^ Te3[s[2] & 0xff] ^ rk[3];
+    s[0] = t0; s[1] = t1; s[2] = t2; s[3] = t3;
+}
+
+// One inverse T-table round: InvSubBytes + InvShiftRows + InvMixColumns + AddRoundKey
+static AES_FORCE_INLINE void decryptRound(uint32_t* s, const uint32_t* dk) {
+    uint32_t t0 = Td0[s[0] >> 24] ^ Td1[(s[3] >> 16) & 0xff] ^ Td2[(s[2] >> 8) & 0xff] ^ Td3[s[1] & 0xff] ^ dk[0];
+    uint32_t t1 = Td0[s[1] >> 24] ^ Td1[(s[0] >> 16) & 0xff] ^ Td2[(s[3] >> 8) & 0xff] ^ Td3[s[2] & 0xff] ^ dk[1];
+    uint32_t t2 = Td0[s[2] >> 24] ^ Td1[(s[1] >> 16) & 0xff] ^ Td2[(s[0] >> 8) & 0xff] ^ Td3[s[3] & 0xff] ^ dk[2];
+    uint32_t t3 = Td0[s[3] >> 24] ^ Td1[(s[2] >> 16) & 0xff] ^ Td2[(s[1] >> 8) & 0xff] ^ Td3[s[0] & 0xff] ^ dk[3];
+    s[0] = t0; s[1] = t1; s[2] = t2; s[3] = t3;
+}
 
-    result[0] = input[0];
-    result[1] = input[13];
-    result[2] = input[10];
-    result[3] = input[7];
+// Rounds 1..Nr-1 expanded at compile time, one call per round key
+template <size_t... R>
+static inline void encryptRounds(uint32_t* s, const uint32_t* rk, std::index_sequence<R...>) {
+    (encryptRound(s, rk + 4 * (R + 1)), ...);
+}
 
-    result[4] = input[4];
-    result[5] = input[1];
-    result[6] = input[14];
-    result[7] = input[11];
+template <size_t... R>
+static inline void decryptRounds(uint32_t* s, const uint32_t* dk, std::index_sequence<R...>) {
+    (decryptRound(s, dk + 4 * (R + 1)), ...);
+}
 
-    result[8] = input[8];
-    result[9] = input[5];
-    result[10] = input[2];
-    result[11] = input[15];
+// AES encryption of one block; input and output may alias
+template <int Nr>
+void encrypt(const uint8_t* input, uint8_t* output, const uint32_t* rk) {
+    // ROUND 0
+    uint32_t s[4];
+    for (int j = 0; j < 4; j++) {
+        s[j] = loadWord(input + 4 * j) ^ rk[j];
+    }
 
-    result[12] = input[12];
-    result[13] = input[9];
-    result[14] = input[6];
-    result[15] = input[3];
+    // ROUNDS 1 to Nr-1
+    encryptRounds(s, rk, std::make_index_sequence<Nr - 1>());
 
-    for (int i = 0; i < 16; i++) {
-        input[i] = result[i];
+    // ROUND Nr: no MixColumns
+    rk += 4 * Nr;
+    for (int j = 0; j < 4; j++) {
+        uint32_t t = ((uint32_t)sbox[s[j] >> 24] << 24) ^ ((uint32_t)sbox[(s[(j + 1) & 3] >> 16) & 0xff] << 16) ^
+                     ((uint32_t)sbox[(s[(j + 2) & 3] >> 8) & 0xff] << 8) ^ (uint32_t)sbox[s[(j + 3) & 3] & 0xff];
+        storeWord(output + 4 * j, t ^ rk[j]);
     }
 }
 
-// Multiplication by 2 in GF(2^8) - based on reference
-uint8_t mul2(uint8_t in) {
-    uint8_t res = (2 * in);
-    if (res & 0x100) {
-        res = res ^ 0x1b;
+// AES decryption of one block (equivalent inverse cipher); dk comes from extendDecryptionKey
+template <int Nr>
+void decrypt(const uint8_t* input, uint8_t* output, const uint32_t* dk) {
+    // ROUND Nr
+    uint32_t s[4];
+    for (int j = 0; j < 4; j++) {
+        s[j] = loadWord(input + 4 * j) ^ dk[j];
     }
-    return res;
+
+    // ROUNDS Nr-1 to 1
+    decryptRounds(s, dk, std::make_index_sequence<Nr - 1>());
+
+    // ROUND 0: no InvMixColumns
+    dk += 4 * Nr;
+    for (int j = 0; j < 4; j++) {
+        uint32_t t = ((uint32_t)rsbox[s[j] >> 24] << 24) ^ ((uint32_t)rsbox[(s[(j + 3) & 3] >> 16) & 0xff] << 16) ^
+                     ((uint32_t)rsbox[(s[(j + 2) & 3] >> 8) & 0xff] << 8) ^ (uint32_t)rsbox[s[(j + 1) & 3] & 0xff];
+        storeWord(output + 4 * j, t ^ dk[j]);
+    }
+}
+
+#ifdef __wasm_simd128__
+// Bitsliced AES for WASM SIMD128 (layout follows BearSSL's aes_ct64, with
+// each 64-bit lane of a v128 running one 4-block group). Eight blocks are
+// spread over eight v128 words so that word i holds bit i of every state
+// byte; S-boxes become a fixed boolean circuit and no lookup depends on
+// secret data.
+
+// Blocks handled per bitsliced pass, and the smallest input worth slicing
+#define BITSLICE_BLOCKS 8
+#define BITSLICE_MIN_LEN (16 * BITSLICE_BLOCKS)
+
+static inline v128_t bsMask(uint64_t m) {
+    return wasm_i64x2_splat((int64_t)m);
+}
+
+// Rotate each 64-bit lane right by 16 and 32 bits (one and two rows)
+static inline v128_t bsRotr16(v128_t x) {
+    return wasm_i16x8_shuffle(x, x, 1, 2, 3, 0, 5, 6, 7, 4);
 }
 
-// Multiplication by 3 in GF(2^8) - based on reference
-uint8_t mul3(uint8_t in) {
-    uint8_t res = (2 * in) ^ in;
-    if (res & 0x100) {
-        res = res ^ 0x1b;
+static inline v128_t bsRotr32(v128_t x) {
+    return wasm_i32x4_shuffle(x, x, 1, 0, 3, 2);
+}
+
+// Spread one block's little-endian words over the even/odd bytes of two lanes
+static inline void bsInterleaveIn(uint64_t* q0, uint64_t* q1, const uint8_t* block) {
+    uint64_t x[4];
+    for (int i = 0; i < 4; i++) {
+        uint64_t w = (uint64_t)block[4 * i] | ((uint64_t)block[4 * i + 1] << 8) |
+                     ((uint64_t)block[4 * i + 2] << 16) | ((uint64_t)block[4 * i + 3] << 24);
+        w = (w | (w << 16)) & 0x0000FFFF0000FFFFull;
+        w = (w | (w << 8)) & 0x00FF00FF00FF00FFull;
+        x[i] = w;
     }
-    return res;
+    *q0 = x[0] | (x[2] << 8);
+    *q1 = x[1] | (x[3] << 8);
 }
 
-// MixColumns - based on reference implementation
-void mixColumn(uint8_t* input) {
-    uint8_t result[16];
+static inline void bsInterleaveOut(uint8_t* block, uint64_t q0, uint64_t q1) {
+    uint64_t x[4];
+    x[0] = q0 & 0x00FF00FF00FF00FFull;
+    x[1] = q1 & 0x00FF00FF00FF00FFull;
+    x[2] = (q0 >> 8) & 0x00FF00FF00FF00FFull;
+    x[3] = (q1 >> 8) & 0x00FF00FF00FF00FFull;
+    for (int i = 0; i < 4; i++) {
+        uint64_t w = (x[i] | (x[i] >> 8)) & 0x0000FFFF0000FFFFull;
+        uint32_t v = (uint32_t)w | (uint32_t)(w >> 16);
+        block[4 * i] = (uint8_t)v;
+        block[4 * i + 1] = (uint8_t)(v >> 8);
+        block[4 * i + 2] = (uint8_t)(v >> 16);
+        block[4 * i + 3] = (uint8_t)(v >> 24);
+    }
+}
+
+// Transpose between byte-interleaved and bitsliced form (self-inverse)
+static inline void bsSwap(v128_t& x, v128_t& y, uint64_t lo, int s) {
+    v128_t cl = bsMask(lo), ch = bsMask(~lo);
+    v128_t a = x, b = y;
+    x = wasm_v128_or(wasm_v128_and(a, cl), wasm_i64x2_shl(wasm_v128_and(b, cl), s));
+    y = wasm_v128_or(wasm_u64x2_shr(wasm_v128_and(a, ch), s), wasm_v128_and(b, ch));
+}
+
+static inline void bsOrtho(v128_t* q) {
+    bsSwap(q[0], q[1], 0x5555555555555555ull, 1);
+    bsSwap(q[2], q[3], 0x5555555555555555ull, 1);
+    bsSwap(q[4], q[5], 0x5555555555555555ull, 1);
+    bsSwap(q[6], q[7], 0x5555555555555555ull, 1);
+
+    bsSwap(q[0], q[2], 0x3333333333333333ull, 2);
+    bsSwap(q[1], q[3], 0x3333333333333333ull, 2);
+    bsSwap(q[4], q[6], 0x3333333333333333ull, 2);
+    bsSwap(q[5], q[7], 0x3333333333333333ull, 2);
 
+    bsSwap(q[0], q[4], 0x0F0F0F0F0F0F0F0Full, 4);
+    bsSwap(q[1], q[5], 0x0F0F0F0F0F0F0F0Full, 4);
+    bsSwap(q[2], q[6], 0x0F0F0F0F0F0F0F0Full, 4);
+    bsSwap(q[3], q[7], 0x0F0F0F0F0F0F0F0Full, 4);
+}
+
+// Load 8 blocks (blocks 0-3 in lane 0, 4-7 in lane 1) into bitsliced form
+static inline void bsLoad(v128_t* q, const uint8_t* in) {
     for (int i = 0; i < 4; i++) {
-        result[4 * i + 0] = mul2(input[4 * i]) ^ mul3(input[4 * i + 1]) ^ input[4 * i + 2] ^ input[4 * i + 3];
-        result[4 * i + 1] = input[4 * i] ^ mul2(input[4 * i + 1]) ^ mul3(input[4 * i + 2]) ^ input[4 * i + 3];
-        result[4 * i + 2] = input[4 * i] ^ input[4 * i + 1] ^ mul2(input[4 * i + 2]) ^ mul3(input[4 * i + 3]);
-        result[4 * i + 3] = mul3(input[4 * i]) ^ input[4 * i + 1] ^ input[4 * i + 2] ^ mul2(input[4 * i + 3]);
+        uint64_t a0, a1, b0, b1;
+        bsInterleaveIn(&a0, &a1, in + 16 * i);
+        bsInterleaveIn(&b0, &b1, in + 16 * (i + 4));
+        q[i] = wasm_i64x2_make((int64_t)a0, (int64_t)b0);
+        q[i + 4] = wasm_i64x2_make((int64_t)a1, (int64_t)b1);
     }
+    bsOrtho(q);
+}
 
-    for (int i = 0; i < 16; i++) {
-        input[i] = result[i];
+static inline void bsStore(uint8_t* out, v128_t* q) {
+    bsOrtho(q);
+    for (int i = 0; i < 4; i++) {
+        bsInterleaveOut(out + 16 * i, (uint64_t)wasm_i64x2_extract_lane(q[i], 0),
+                        (uint64_t)wasm_i64x2_extract_lane(q[i + 4], 0));
+        bsInterleaveOut(out + 16 * (i + 4), (uint64_t)wasm_i64x2_extract_lane(q[i], 1),
+                        (uint64_t)wasm_i64x2_extract_lane(q[i + 4], 1));
     }
 }
 
-// Multiplication by 9, 11, 13, 14 in GF(2^8) for InvMixColumns
-uint8_t mul9(uint8_t in) {
-    return mul2(mul2(mul2(in))) ^ in; // 8 + 1 = 9
+// SubBytes as the Boyar-Peralta circuit (113 gates)
+static inline void bsSbox(v128_t* q) {
+    v128_t x0, x1, x2, x3, x4, x5, x6, x7;
+    v128_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+    v128_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    v128_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11;
+    v128_t z12, z13, z14, z15, z16, z17;
+    v128_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11;
+    v128_t t12, t13, t14, t15, t16, t17, t18, t19, t20, t21, t22;
+    v128_t t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33;
+    v128_t t34, t35, t36, t37, t38, t39, t40, t41, t42, t43, t44;
+    v128_t t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55;
+    v128_t t56, t57, t58, t59, t60, t61, t62, t63, t64, t65, t66, t67;
+    v128_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    // Top linear transformation
+    y14 = wasm_v128_xor(x3, x5);
+    y13 = wasm_v128_xor(x0, x6);
+    y9 = wasm_v128_xor(x0, x3);
+    y8 = wasm_v128_xor(x0, x5);
+    t0 = wasm_v128_xor(x1, x2);
+    y1 = wasm_v128_xor(t0, x7);
+    y4 = wasm_v128_xor(y1, x3);
+    y12 = wasm_v128_xor(y13, y14);
+    y2 = wasm_v128_xor(y1, x0);
+    y5 = wasm_v128_xor(y1, x6);
+    y3 = wasm_v128_xor(y5, y8);
+    t1 = wasm_v128_xor(x4, y12);
+    y15 = wasm_v128_xor(t1, x5);
+    y20 = wasm_v128_xor(t1, x1);
+    y6 = wasm_v128_xor(y15, x7);
+    y10 = wasm_v128_xor(y15, t0);
+    y11 = wasm_v128_xor(y20, y9);
+    y7 = wasm_v128_xor(x7, y11);
+    y17 = wasm_v128_xor(y10, y11);
+    y19 = wasm_v128_xor(y10, y8);
+    y16 = wasm_v128_xor(t0, y11);
+    y21 = wasm_v128_xor(y13, y16);
+    y18 = wasm_v128_xor(x0, y16);
+
+    // Non-linear section
+    t2 = wasm_v128_and(y12, y15);
+    t3 = wasm_v128_and(y3, y6);
+    t4 = wasm_v128_xor(t3, t2);
+    t5 = wasm_v128_and(y4, x7);
+    t6 = wasm_v128_xor(t5, t2);
+    t7 = wasm_v128_and(y13, y16);
+    t8 = wasm_v128_and(y5, y1);
+    t9 = wasm_v128_xor(t8, t7);
+    t10 = wasm_v128_and(y2, y7);
+    t11 = wasm_v128_xor(t10, t7);
+    t12 = wasm_v128_and(y9, y11);
+    t13 = wasm_v128_and(y14, y17);
+    t14 = wasm_v128_xor(t13, t12);
+    t15 = wasm_v128_and(y8, y10);
+    t16 = wasm_v128_xor(t15, t12);
+    t17 = wasm_v128_xor(t4, t14);
+    t18 = wasm_v128_xor(t6, t16);
+    t19 = wasm_v128_xor(t9, t14);
+    t20 = wasm_v128_xor(t11, t16);
+    t21 = wasm_v128_xor(t17, y20);
+    t22 = wasm_v128_xor(t18, y19);
+    t23 = wasm_v128_xor(t19, y21);
+    t24 = wasm_v128_xor(t20, y18);
+
+    t25 = wasm_v128_xor(t21, t22);
+    t26 = wasm_v128_and(t21, t23);
+    t27 = wasm_v128_xor(t24, t26);
+    t28 = wasm_v128_and(t25, t27);
+    t29 = wasm_v128_xor(t28, t22);
+    t30 = wasm_v128_xor(t23, t24);
+    t31 = wasm_v128_xor(t22, t26);
+    t32 = wasm_v128_and(t31, t30);
+    t33 = wasm_v128_xor(t32, t24);
+    t34 = wasm_v128_xor(t23, t33);
+    t35 = wasm_v128_xor(t27, t33);
+    t36 = wasm_v128_and(t24, t35);
+    t37 = wasm_v128_xor(t36, t34);
+    t38 = wasm_v128_xor(t27, t36);
+    t39 = wasm_v128_and(t29, t38);
+    t40 = wasm_v128_xor(t25, t39);
+
+    t41 = wasm_v128_xor(t40, t37);
+    t42 = wasm_v128_xor(t29, t33);
+    t43 = wasm_v128_xor(t29, t40);
+    t44 = wasm_v128_xor(t33, t37);
+    t45 = wasm_v128_xor(t42, t41);
+    z0 = wasm_v128_and(t44, y15);
+    z1 = wasm_v128_and(t37, y6);
+    z2 = wasm_v128_and(t33, x7);
+    z3 = wasm_v128_and(t43, y16);
+    z4 = wasm_v128_and(t40, y1);
+    z5 = wasm_v128_and(t29, y7);
+    z6 = wasm_v128_and(t42, y11);
+    z7 = wasm_v128_and(t45, y17);
+    z8 = wasm_v128_and(t41, y10);
+    z9 = wasm_v128_and(t44, y12);
+    z10 = wasm_v128_and(t37, y3);
+    z11 = wasm_v128_and(t33, y4);
+    z12 = wasm_v128_and(t43, y13);
+    z13 = wasm_v128_and(t40, y5);
+    z14 = wasm_v128_and(t29, y2);
+    z15 = wasm_v128_and(t42, y9);
+    z16 = wasm_v128_and(t45, y14);
+    z17 = wasm_v128_and(t41, y8);
+
+    // Bottom linear transformation
+    t46 = wasm_v128_xor(z15, z16);
+    t47 = wasm_v128_xor(z10, z11);
+    t48 = wasm_v128_xor(z5, z13);
+    t49 = wasm_v128_xor(z9, z10);
+    t50 = wasm_v128_xor(z2, z12);
+    t51 = wasm_v128_xor(z2, z5);
+    t52 = wasm_v128_xor(z7, z8);
+    t53 = wasm_v128_xor(z0, z3);
+    t54 = wasm_v128_xor(z6, z7);
+    t55 = wasm_v128_xor(z16, z17);
+    t56 = wasm_v128_xor(z12, t48);
+    t57 = wasm_v128_xor(t50, t53);
+    t58 = wasm_v128_xor(z4, t46);
+    t59 = wasm_v128_xor(z3, t54);
+    t60 = wasm_v128_xor(t46, t57);
+    t61 = wasm_v128_xor(z14, t57);
+    t62 = wasm_v128_xor(t52, t58);
+    t63 = wasm_v128_xor(t49, t58);
+    t64 = wasm_v128_xor(z4, t59);
+    t65 = wasm_v128_xor(t61, t62);
+    t66 = wasm_v128_xor(z1, t63);
+    s0 = wasm_v128_xor(t59, t63);
+    s6 = wasm_v128_xor(t56, wasm_v128_not(t62));
+    s7 = wasm_v128_xor(t48, wasm_v128_not(t60));
+    t67 = wasm_v128_xor(t64, t65);
+    s3 = wasm_v128_xor(t53, t66);
+    s4 = wasm_v128_xor(t51, t66);
+    s5 = wasm_v128_xor(t47, t65);
+    s1 = wasm_v128_xor(t64, wasm_v128_not(s3));
+    s2 = wasm_v128_xor(t55, wasm_v128_not(t67));
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
 }
 
-uint8_t mul11(uint8_t in) {
-    return mul2(mul2(mul2(in))) ^ mul2(in) ^ in; // 8 + 2 + 1 = 11
+// Inverse affine map; InvSubBytes = invAffine . SubBytes . invAffine
+static inline void bsInvAffine(v128_t* q) {
+    v128_t q0 = wasm_v128_not(q[0]);
+    v128_t q1 = wasm_v128_not(q[1]);
+    v128_t q2 = q[2];
+    v128_t q3 = q[3];
+    v128_t q4 = q[4];
+    v128_t q5 = wasm_v128_not(q[5]);
+    v128_t q6 = wasm_v128_not(q[6]);
+    v128_t q7 = q[7];
+    q[7] = wasm_v128_xor(wasm_v128_xor(q1, q4), q6);
+    q[6] = wasm_v128_xor(wasm_v128_xor(q0, q3), q5);
+    q[5] = wasm_v128_xor(wasm_v128_xor(q7, q2), q4);
+    q[4] = wasm_v128_xor(wasm_v128_xor(q6, q1), q3);
+    q[3] = wasm_v128_xor(wasm_v128_xor(q5, q0), q2);
+    q[2] = wasm_v128_xor(wasm_v128_xor(q4, q7), q1);
+    q[1] = wasm_v128_xor(wasm_v128_xor(q3, q6), q0);
+    q[0] = wasm_v128_xor(wasm_v128_xor(q2, q5), q7);
 }
 
-uint8_t mul13(uint8_t in) {
-    return mul2(mul2(mul2(in))) ^ mul2(mul2(in)) ^ in; // 8 + 4 + 1 = 13
+static inline void bsInvSbox(v128_t* q) {
+    bsInvAffine(q);
+    bsSbox(q);
+    bsInvAffine(q);
 }
 
-uint8_t mul14(uint8_t in) {
-    return mul2(mul2(mul2(in))) ^ mul2(mul2(in)) ^ mul2(in); // 8 + 4 + 2 = 14
+// Gather bits selected by mask, shifted left (s > 0) or right (s < 0)
+static inline v128_t bsPick(v128_t x, uint64_t mask, int s) {
+    v128_t m = wasm_v128_and(x, bsMask(mask));
+    return s >= 0 ? wasm_i64x2_shl(m, s) : wasm_u64x2_shr(m, -s);
 }
 
-// InvMixColumns
-void invMixColumn(uint8_t* input) {
-    uint8_t result[16];
+static inline void bsShiftRows(v128_t* q) {
+    for (int i = 0; i < 8; i++) {
+        v128_t x = q[i];
+        q[i] = wasm_v128_or(
+            wasm_v128_or(wasm_v128_or(bsPick(x, 0x000000000000FFFFull, 0), bsPick(x, 0x00000000FFF00000ull, -4)),
+                         wasm_v128_or(bsPick(x, 0x00000000000F0000ull, 12), bsPick(x, 0x0000FF0000000000ull, -8))),
+            wasm_v128_or(wasm_v128_or(bsPick(x, 0x000000FF00000000ull, 8), bsPick(x, 0xF000000000000000ull, -12)),
+                         bsPick(x, 0x0FFF000000000000ull, 4)));
+    }
+}
 
-    for (int i = 0; i < 4; i++) {
-        result[4 * i + 0] = mul14(input[4 * i]) ^ mul11(input[4 * i + 1]) ^ mul13(input[4 * i + 2]) ^ mul9(input[4 * i + 3]);
-        result[4 * i + 1] = mul9(input[4 * i]) ^ mul14(input[4 * i + 1]) ^ mul11(input[4 * i + 2]) ^ mul13(input[4 * i + 3]);
-        result[4 * i + 2] = mul13(input[4 * i]) ^ mul9(input[4 * i + 1]) ^ mul14(input[4 * i + 2]) ^ mul11(input[4 * i + 3]);
-        result[4 * i + 3] = mul11(input[4 * i]) ^ mul13(input[4 * i + 1]) ^ mul9(input[4 * i + 2]) ^ mul14(input[4 * i + 3]);
+static inline void bsInvShiftRows(v128_t* q) {
+    for (int i = 0; i < 8; i++) {
+        v128_t x = q[i];
+        q[i] = wasm_v128_or(
+            wasm_v128_or(wasm_v128_or(bsPick(x, 0x000000000000FFFFull, 0), bsPick(x, 0x000000000FFF0000ull, 4)),
+                         wasm_v128_or(bsPick(x, 0x00000000F0000000ull, -12), bsPick(x, 0x000000FF00000000ull, 8))),
+            wasm_v128_or(wasm_v128_or(bsPick(x, 0x0000FF0000000000ull, -8), bsPick(x, 0x000F000000000000ull, 12)),
+                         bsPick(x, 0xFFF0000000000000ull, -4)));
     }
+}
 
-    for (int i = 0; i < 16; i++) {
-        input[i] = result[i];
+// MixColumns: out = 2 * (a0 ^ a1) ^ a1 ^ a2 ^ a3, where r is the column
+// rotated by one row and bsRotr32 rotates by two rows
+static inline void bsMixColumns(v128_t* q) {
+    v128_t r[8], a[8];
+    for (int i = 0; i < 8; i++) {
+        r[i] = bsRotr16(q[i]);
+        a[i] = wasm_v128_xor(q[i], r[i]);
     }
+    q[0] = wasm_v128_xor(wasm_v128_xor(a[7], r[0]), bsRotr32(a[0]));
+    q[1] = wasm_v128_xor(wasm_v128_xor(wasm_v128_xor(a[0], a[7]), r[1]), bsRotr32(a[1]));
+    q[2] = wasm_v128_xor(wasm_v128_xor(a[1], r[2]), bsRotr32(a[2]));
+    q[3] = wasm_v128_xor(wasm_v128_xor(wasm_v128_xor(a[2], a[7]), r[3]), bsRotr32(a[3]));
+    q[4] = wasm_v128_xor(wasm_v128_xor(wasm_v128_xor(a[3], a[7]), r[4]), bsRotr32(a[4]));
+    q[5] = wasm_v128_xor(wasm_v128_xor(a[4], r[5]), bsRotr32(a[5]));
+    q[6] = wasm_v128_xor(wasm_v128_xor(a[5], r[6]), bsRotr32(a[6]));
+    q[7] = wasm_v128_xor(wasm_v128_xor(a[6], r[7]), bsRotr32(a[7]));
 }
 
-// Key expansion function f - based on reference
-void f(uint8_t* extendedKey, int index) {
-    extendedKey[(index + 1) * 4] = sbox[extendedKey[index * 4 + 1]] ^ rcon[((index + 1) / 4)];
-    extendedKey[(index + 1) * 4 + 1] = sbox[extendedKey[index * 4 + 2]];
-    extendedKey[(index + 1) * 4 + 2] = sbox[extendedKey[index * 4 + 3]];
-    extendedKey[(index + 1) * 4 + 3] = sbox[extendedKey[index * 4]];
+// InvMixColumns = MixColumns . P, where P adds 4 * (a_i ^ a_(i+2)) to each byte
+static inline void bsInvMixColumns(v128_t* q) {
+    v128_t t[8];
+    for (int i = 0; i < 8; i++) {
+        t[i] = wasm_v128_xor(q[i], bsRotr32(q[i]));
+    }
+    // Multiply t by 4 = x^2 (bit i of the product gathers bits i-2, plus
+    // the reduction terms of bits 6 and 7)
+    v128_t u0 = t[6];
+    v128_t u1 = wasm_v128_xor(t[6], t[7]);
+    v128_t u2 = wasm_v128_xor(t[0], t[7]);
+    v128_t u3 = wasm_v128_xor(t[1], t[6]);
+    v128_t u4 = wasm_v128_xor(wasm_v128_xor(t[2], t[6]), t[7]);
+    v128_t u5 = wasm_v128_xor(t[3], t[7]);
+    v128_t u6 = t[4];
+    v128_t u7 = t[5];
+    q[0] = wasm_v128_xor(q[0], u0);
+    q[1] = wasm_v128_xor(q[1], u1);
+    q[2] = wasm_v128_xor(q[2], u2);
+    q[3] = wasm_v128_xor(q[3], u3);
+    q[4] = wasm_v128_xor(q[4], u4);
+    q[5] = wasm_v128_xor(q[5], u5);
+    q[6] = wasm_v128_xor(q[6], u6);
+    q[7] = wasm_v128_xor(q[7], u7);
+    bsMixColumns(q);
 }
 
-// Key expansion - based on reference implementation
-void extendKey(uint8_t* key, uint8_t* extendedKey) {
-    for (int i = 0; i < 16; i++) {
-        extendedKey[i] = key[i];
+static inline void bsAddRoundKey(v128_t* q, const v128_t* sk) {
+    for (int i = 0; i < 8; i++) {
+        q[i] = wasm_v128_xor(q[i], sk[i]);
     }
-    
-    for (int i = 1; i <= 10; i++) {
-        int w_index = i * 4;
-        f(extendedKey, w_index - 1);
+}
+
+// Bitsliced round keys: each round key replicated over the 8 block slots
+template <int Nr>
+void bitsliceKey(const uint32_t* roundKeys, v128_t* sk) {
+    for (int round = 0; round <= Nr; round++) {
+        uint8_t block[16];
         for (int j = 0; j < 4; j++) {
-            extendedKey[w_index * 4 + j] ^= extendedKey[(w_index - 4) * 4 + j];
+            storeWord(block + 4 * j, roundKeys[4 * round + j]);
+        }
+        uint64_t k0, k1;
+        bsInterleaveIn(&k0, &k1, block);
+        v128_t* q = sk + 8 * round;
+        for (int i = 0; i < 4; i++) {
+            q[i] = wasm_i64x2_splat((int64_t)k0);
+            q[i + 4] = wasm_i64x2_splat((int64_t)k1);
         }
+        bsOrtho(q);
+    }
+}
+
+// Encrypt 8 consecutive blocks; input and output may alias
+template <int Nr>
+void encrypt8(const uint8_t* input, uint8_t* output, const v128_t* sk) {
+    v128_t q[8];
+    bsLoad(q, input);
+    bsAddRoundKey(q, sk);
+    for (int i = 1; i < Nr; i++) {
+        bsSbox(q);
+        bsShiftRows(q);
+        bsMixColumns(q);
+        bsAddRoundKey(q, sk + 8 * i);
+    }
+    bsSbox(q);
+    bsShiftRows(q);
+    bsAddRoundKey(q, sk + 8 * Nr);
+    bsStore(output, q);
+}
 
-        for (int k = 0; k < 4 - 1; k++) {
-            w_index++;
-            for (int j = 0; j < 4; j++) {
-                extendedKey[w_index * 4 + j] = extendedKey[(w_index - 4) * 4 + j] ^ extendedKey[(w_index - 1) * 4 + j];
+// Decrypt 8 consecutive blocks with the same bitsliced (forward) round keys
+template <int Nr>
+void decrypt8(const uint8_t* input, uint8_t* output, const v128_t* sk) {
+    v128_t q[8];
+    bsLoad(q, input);
+    bsAddRoundKey(q, sk + 8 * Nr);
+    for (int i = Nr - 1; i >= 1; i--) {
+        bsInvShiftRows(q);
+        bsInvSbox(q);
+        bsAddRoundKey(q, sk + 8 * i);
+        bsInvMixColumns(q);
+    }
+    bsInvShiftRows(q);
+    bsInvSbox(q);
+    bsAddRoundKey(q, sk);
+    bsStore(output, q);
+}
+#endif // __wasm_simd128__
+
+#ifdef AES_NATIVE_X86
+// Native AES-NI / PCLMULQDQ backend, selected at runtime from CPUID. The
+// portable code above stays the fallback on CPUs without these instructions.
+
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#define CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+// Blocks kept in flight per AES-NI pass to hide the aesenc latency
+#define AESNI_PIPELINE_BLOCKS 8
+
+struct CpuFeatures {
+    bool aesni;
+    bool pclmul;
+};
+
+static CpuFeatures detectCpuFeatures() {
+    CpuFeatures f = {false, false};
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        f.aesni = (ecx & bit_AES) != 0 && (ecx & bit_SSE4_1) != 0;
+        f.pclmul = (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSSE3) != 0;
+    }
+    return f;
+}
+
+static const CpuFeatures cpuFeatures = detectCpuFeatures();
+
+// Round keys in the byte order aesenc expects
+template <int Nr>
+void niLoadKeys(const uint32_t* roundKeys, __m128i* niKeys) {
+    for (int round = 0; round <= Nr; round++) {
+        uint8_t block[16];
+        for (int j = 0; j < 4; j++) {
+            storeWord(block + 4 * j, roundKeys[4 * round + j]);
+        }
+        niKeys[round] = _mm_loadu_si128((const __m128i*)block);
+    }
+}
+
+// Equivalent-inverse-cipher keys for aesdec
+template <int Nr>
+AESNI_TARGET void niDecryptionKeys(const __m128i* niKeys, __m128i* niDecKeys) {
+    niDecKeys[0] = niKeys[Nr];
+    for (int round = 1; round < Nr; round++) {
+        niDecKeys[round] = _mm_aesimc_si128(niKeys[Nr - round]);
+    }
+    niDecKeys[Nr] = niKeys[0];
+}
+
+template <int Nr>
+AESNI_TARGET void niEncryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const __m128i* rk) {
+    int i = 0;
+    for (; i + AESNI_PIPELINE_BLOCKS <= nblocks; i += AESNI_PIPELINE_BLOCKS) {
+        __m128i b[AESNI_PIPELINE_BLOCKS];
+        for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+            b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + 16 * (i + j))), rk[0]);
+        }
+        for (int round = 1; round < Nr; round++) {
+            for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+                b[j] = _mm_aesenc_si128(b[j], rk[round]);
             }
         }
+        for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+            _mm_storeu_si128((__m128i*)(output + 16 * (i + j)), _mm_aesenclast_si128(b[j], rk[Nr]));
+        }
+    }
+    for (; i < nblocks; i++) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + 16 * i)), rk[0]);
+        for (int round = 1; round < Nr; round++) {
+            b = _mm_aesenc_si128(b, rk[round]);
+        }
+        _mm_storeu_si128((__m128i*)(output + 16 * i), _mm_aesenclast_si128(b, rk[Nr]));
     }
 }
 
-// AES encryption - based on reference implementation
-void encrypt(uint8_t* input, uint8_t* extendedKey) {
-    // ROUND 0
-    addRoundKey(input, extendedKey);
+template <int Nr>
+AESNI_TARGET void niDecryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const __m128i* dk) {
+    int i = 0;
+    for (; i + AESNI_PIPELINE_BLOCKS <= nblocks; i += AESNI_PIPELINE_BLOCKS) {
+        __m128i b[AESNI_PIPELINE_BLOCKS];
+        for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+            b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + 16 * (i + j))), dk[0]);
+        }
+        for (int round = 1; round < Nr; round++) {
+            for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+                b[j] = _mm_aesdec_si128(b[j], dk[round]);
+            }
+        }
+        for (int j = 0; j < AESNI_PIPELINE_BLOCKS; j++) {
+            _mm_storeu_si128((__m128i*)(output + 16 * (i + j)), _mm_aesdeclast_si128(b[j], dk[Nr]));
+        }
+    }
+    for (; i < nblocks; i++) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + 16 * i)), dk[0]);
+        for (int round = 1; round < Nr; round++) {
+            b = _mm_aesdec_si128(b, dk[round]);
+        }
+        _mm_storeu_si128((__m128i*)(output + 16 * i), _mm_aesdeclast_si128(b, dk[Nr]));
+    }
+}
+
+// GF(2^128) multiply for GHASH on byte-reversed operands (Intel's
+// carry-less multiplication white paper, algorithm 5)
+CLMUL_TARGET static inline __m128i niGfMul(__m128i a, __m128i b) {
+    __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+    __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+    __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
 
-    for (int i = 1; i < 10; i++) {
-        byteSubstitution(input);
-        shiftRows(input);
-        mixColumn(input);
-        addRoundKey(input, extendedKey + 16 * i);
+    t4 = _mm_xor_si128(t4, t5);
+    t5 = _mm_slli_si128(t4, 8);
+    t4 = _mm_srli_si128(t4, 8);
+    t3 = _mm_xor_si128(t3, t5);
+    t6 = _mm_xor_si128(t6, t4);
+
+    // Shift the 256-bit product left by one (GCM's reflected bit order)
+    __m128i t7 = _mm_srli_epi32(t3, 31);
+    __m128i t8 = _mm_srli_epi32(t6, 31);
+    t3 = _mm_slli_epi32(t3, 1);
+    t6 = _mm_slli_epi32(t6, 1);
+    __m128i t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    t3 = _mm_or_si128(t3, t7);
+    t6 = _mm_or_si128(t6, t8);
+    t6 = _mm_or_si128(t6, t9);
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1
+    t7 = _mm_slli_epi32(t3, 31);
+    t8 = _mm_slli_epi32(t3, 30);
+    t9 = _mm_slli_epi32(t3, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    t3 = _mm_xor_si128(t3, t7);
+
+    __m128i t2 = _mm_srli_epi32(t3, 1);
+    t4 = _mm_srli_epi32(t3, 2);
+    t5 = _mm_srli_epi32(t3, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    t3 = _mm_xor_si128(t3, t2);
+    return _mm_xor_si128(t6, t3);
+}
+
+// ghashUpdate() with PCLMULQDQ; H is the hash key as raw bytes
+CLMUL_TARGET void niGhashUpdate(const uint8_t* H, uint8_t* y, const uint8_t* data, int len) {
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)H), bswap);
+    __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)y), bswap);
+
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i)), bswap);
+        acc = niGfMul(_mm_xor_si128(acc, x), h);
+    }
+    if (i < len) {
+        uint8_t last[16] = {0};
+        for (int j = 0; i + j < len; j++) {
+            last[j] = data[i + j];
+        }
+        __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)last), bswap);
+        acc = niGfMul(_mm_xor_si128(acc, x), h);
     }
 
-    // ROUND 10
-    byteSubstitution(input);
-    shiftRows(input);
-    addRoundKey(input, extendedKey + 16 * 10);
+    _mm_storeu_si128((__m128i*)y, _mm_shuffle_epi8(acc, bswap));
 }
+#endif // AES_NATIVE_X86
 
-// AES decryption
-void decrypt(uint8_t* input, uint8_t* extendedKey) {
-    // ROUND 10
-    addRoundKey(input, extendedKey + 16 * 10);
-    invShiftRows(input);
-    invByteSubstitution(input);
+// Expanded encryption key for the multi-block kernels, for any key size
+struct AesEncryptKey {
+    int rounds;
+    uint32_t roundKeys[4 * (AES_MAX_ROUNDS + 1)];
+#ifdef __wasm_simd128__
+    v128_t bitslicedKeys[8 * (AES_MAX_ROUNDS + 1)];
+#endif
+#ifdef AES_NATIVE_X86
+    bool aesni;
+    __m128i niKeys[AES_MAX_ROUNDS + 1];
+#endif
+};
 
-    for (int i = 9; i >= 1; i--) {
-        addRoundKey(input, extendedKey + 16 * i);
-        invMixColumn(input);
-        invShiftRows(input);
-        invByteSubstitution(input);
+template <int Nk>
+void setupEncryptKey(const uint8_t* key, AesEncryptKey* ek) {
+    ek->rounds = Nk + 6;
+    extendKey<Nk>(key, ek->roundKeys);
+#ifdef __wasm_simd128__
+    bitsliceKey<Nk + 6>(ek->roundKeys, ek->bitslicedKeys);
+#endif
+#ifdef AES_NATIVE_X86
+    ek->aesni = cpuFeatures.aesni;
+    if (ek->aesni) {
+        niLoadKeys<Nk + 6>(ek->roundKeys, ek->niKeys);
     }
+#endif
+}
 
-    // ROUND 0
-    addRoundKey(input, extendedKey);
+// Returns false unless keyLen is 16, 24 or 32 bytes
+bool setupEncryptKey(const uint8_t* key, int keyLen, AesEncryptKey* ek) {
+    switch (keyLen) {
+        case 16: setupEncryptKey<4>(key, ek); return true;
+        case 24: setupEncryptKey<6>(key, ek); return true;
+        case 32: setupEncryptKey<8>(key, ek); return true;
+        default: return false;
+    }
+}
+
+template <int Nr>
+void encryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const AesEncryptKey* ek) {
+#ifdef AES_NATIVE_X86
+    if (ek->aesni) {
+        niEncryptBlocks<Nr>(input, output, nblocks, ek->niKeys);
+        return;
+    }
+#endif
+    int i = 0;
+#ifdef __wasm_simd128__
+    for (; i + BITSLICE_BLOCKS <= nblocks; i += BITSLICE_BLOCKS) {
+        encrypt8<Nr>(input + 16 * i, output + 16 * i, ek->bitslicedKeys);
+    }
+#endif
+    for (; i < nblocks; i++) {
+        encrypt<Nr>(input + 16 * i, output + 16 * i, ek->roundKeys);
+    }
+}
+
+// Encrypt nblocks consecutive blocks, 8 at a time when the SIMD kernel is
+// available. The key size is resolved once per call, outside the block loop.
+void encryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const AesEncryptKey* ek) {
+    switch (ek->rounds) {
+        case AES128_ROUNDS: encryptBlocks<AES128_ROUNDS>(input, output, nblocks, ek); break;
+        case AES192_ROUNDS: encryptBlocks<AES192_ROUNDS>(input, output, nblocks, ek); break;
+        case AES256_ROUNDS: encryptBlocks<AES256_ROUNDS>(input, output, nblocks, ek); break;
+    }
+}
+
+// Expanded decryption key for the multi-block kernels. The bitsliced kernel
+// runs the inverse cipher straight from the encryption round keys.
+struct AesDecryptKey {
+    int rounds;
+    uint32_t decKeys[4 * (AES_MAX_ROUNDS + 1)];
+#ifdef __wasm_simd128__
+    v128_t bitslicedKeys[8 * (AES_MAX_ROUNDS + 1)];
+#endif
+#ifdef AES_NATIVE_X86
+    bool aesni;
+    __m128i niDecKeys[AES_MAX_ROUNDS + 1];
+#endif
+};
+
+template <int Nk>
+void setupDecryptKey(const uint8_t* key, AesDecryptKey* dk) {
+    constexpr int Nr = Nk + 6;
+    uint32_t roundKeys[4 * (Nr + 1)];
+    extendKey<Nk>(key, roundKeys);
+    dk->rounds = Nr;
+    extendDecryptionKey<Nr>(roundKeys, dk->decKeys);
+#ifdef __wasm_simd128__
+    bitsliceKey<Nr>(roundKeys, dk->bitslicedKeys);
+#endif
+#ifdef AES_NATIVE_X86
+    dk->aesni = cpuFeatures.aesni;
+    if (dk->aesni) {
+        __m128i niKeys[Nr + 1];
+        niLoadKeys<Nr>(roundKeys, niKeys);
+        niDecryptionKeys<Nr>(niKeys, dk->niDecKeys);
+    }
+#endif
+}
+
+// Returns false unless keyLen is 16, 24 or 32 bytes
+bool setupDecryptKey(const uint8_t* key, int keyLen, AesDecryptKey* dk) {
+    switch (keyLen) {
+        case 16: setupDecryptKey<4>(key, dk); return true;
+        case 24: setupDecryptKey<6>(key, dk); return true;
+        case 32: setupDecryptKey<8>(key, dk); return true;
+        default: return false;
+    }
+}
+
+template <int Nr>
+void decryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const AesDecryptKey* dk) {
+#ifdef AES_NATIVE_X86
+    if (dk->aesni) {
+        niDecryptBlocks<Nr>(input, output, nblocks, dk->niDecKeys);
+        return;
+    }
+#endif
+    int i = 0;
+#ifdef __wasm_simd128__
+    for (; i + BITSLICE_BLOCKS <= nblocks; i += BITSLICE_BLOCKS) {
+        decrypt8<Nr>(input + 16 * i, output + 16 * i, dk->bitslicedKeys);
+    }
+#endif
+    for (; i < nblocks; i++) {
+        decrypt<Nr>(input + 16 * i, output + 16 * i, dk->decKeys);
+    }
+}
+
+// Decrypt nblocks consecutive blocks; the counterpart of encryptBlocks()
+void decryptBlocks(const uint8_t* input, uint8_t* output, int nblocks, const AesDecryptKey* dk) {
+    switch (dk->rounds) {
+        case AES128_ROUNDS: decryptBlocks<AES128_ROUNDS>(input, output, nblocks, dk); break;
+        case AES192_ROUNDS: decryptBlocks<AES192_ROUNDS>(input, output, nblocks, dk); break;
+        case AES256_ROUNDS: decryptBlocks<AES256_ROUNDS>(input, output, nblocks, dk); break;
+    }
+}
+
+// AES for the mode layer in block_modes.h; dk is only set up for the
+// directions that decrypt
+struct AesBlockCipher {
+    static constexpr int blockSize = 16;
+    AesEncryptKey ek;
+    AesDecryptKey dk;
+
+    void encryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        ::encryptBlocks(input, output, nblocks, &ek);
+    }
+    void decryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        ::decryptBlocks(input, output, nblocks, &dk);
+    }
+};
+
+// Bytes per parallel work item: large enough to amortize the hand-off,
+// small enough that a chunk's input and output stay in L2
+#define AES_PARALLEL_CHUNK (64 * 1024)
+
+// ECB over whole blocks with the key size fixed at compile time. Inputs
+// longer than one chunk are spread over the worker pool.
+template <int Nk>
+void processEcb(const uint8_t* data, int data_len, const uint8_t* key, uint8_t* output, bool encrypt_mode) {
+    constexpr int Nr = Nk + 6;
+    uint32_t roundKeys[4 * (Nr + 1)];
+    uint32_t decKeys[4 * (Nr + 1)];
+    extendKey<Nk>(key, roundKeys);
+    int nchunks = (data_len + AES_PARALLEL_CHUNK - 1) / AES_PARALLEL_CHUNK;
+
+#ifdef AES_NATIVE_X86
+    if (cpuFeatures.aesni) {
+        __m128i niKeys[Nr + 1];
+        __m128i niDecKeys[Nr + 1];
+        niLoadKeys<Nr>(roundKeys, niKeys);
+        if (!encrypt_mode) {
+            niDecryptionKeys<Nr>(niKeys, niDecKeys);
+        }
+        parallelFor(nchunks, [&](int c) {
+            int begin = c * AES_PARALLEL_CHUNK;
+            int nblocks = (data_len - begin < AES_PARALLEL_CHUNK ? data_len - begin : AES_PARALLEL_CHUNK) / 16;
+            if (encrypt_mode) {
+                niEncryptBlocks<Nr>(data + begin, output + begin, nblocks, niKeys);
+            } else {
+                niDecryptBlocks<Nr>(data + begin, output + begin, nblocks, niDecKeys);
+            }
+        });
+        return;
+    }
+#endif
+
+    if (!encrypt_mode) {
+        extendDecryptionKey<Nr>(roundKeys, decKeys);
+    }
+
+#ifdef __wasm_simd128__
+    // Large inputs go through the bitsliced kernel 8 blocks at a time
+    v128_t bitslicedKeys[8 * (Nr + 1)];
+    if (data_len >= BITSLICE_MIN_LEN) {
+        bitsliceKey<Nr>(roundKeys, bitslicedKeys);
+    }
+#endif
+
+    parallelFor(nchunks, [&](int c) {
+        int i = c * AES_PARALLEL_CHUNK;
+        int end = (data_len - i < AES_PARALLEL_CHUNK) ? data_len : i + AES_PARALLEL_CHUNK;
+#ifdef __wasm_simd128__
+        for (; i + BITSLICE_MIN_LEN <= end; i += BITSLICE_MIN_LEN) {
+            if (encrypt_mode) {
+                encrypt8<Nr>(data + i, output + i, bitslicedKeys);
+            } else {
+                decrypt8<Nr>(data + i, output + i, bitslicedKeys);
+            }
+        }
+#endif
+
+        // Process the remaining data in 16-byte (128-bit) chunks straight from input to output
+        for (; i < end; i += 16) {
+            if (encrypt_mode) {
+                encrypt<Nr>(data + i, output + i, roundKeys);
+            } else {
+                decrypt<Nr>(data + i, output + i, decKeys);
+            }
+        }
+    });
+}
+
+// --- AES-CTR streaming mode ---
+
+// Counter blocks encrypted per keystream refill
+#define CTR_BATCH_BLOCKS 32
+
+struct AesCtrState {
+    AesEncryptKey key;
+    uint8_t counter[16];                        // next counter block (big-endian)
+    uint8_t keystream[16 * CTR_BATCH_BLOCKS];
+    int keystreamPos;                           // bytes of keystream already used
+};
+
+// Increment a 128-bit big-endian counter
+static inline void incrementCounter(uint8_t* counter) {
+    for (int i = 15; i >= 0; i--) {
+        if (++counter[i] != 0) break;
+    }
+}
+
+// Encrypt the next CTR_BATCH_BLOCKS counter values in one kernel call
+void refillKeystream(AesCtrState* st) {
+    for (int b = 0; b < CTR_BATCH_BLOCKS; b++) {
+        for (int j = 0; j < 16; j++) {
+            st->keystream[16 * b + j] = st->counter[j];
+        }
+        incrementCounter(st->counter);
+    }
+    encryptBlocks(st->keystream, st->keystream, CTR_BATCH_BLOCKS, &st->key);
+    st->keystreamPos = 0;
+}
+
+// Add n to a 128-bit big-endian counter
+static inline void addCounter(uint8_t* counter, uint64_t n) {
+    for (int i = 15; i >= 0 && n != 0; i--) {
+        uint64_t sum = counter[i] + (n & 0xff);
+        counter[i] = (uint8_t)sum;
+        n = (n >> 8) + (sum >> 8);
+    }
+}
+
+// XOR len bytes (whole blocks) with the keystream that starts at counter
+void ctrXorBlocks(const AesEncryptKey* key, const uint8_t* counter, const uint8_t* data, uint8_t* output, int len) {
+    uint8_t ctr[16];
+    uint8_t keystream[16 * CTR_BATCH_BLOCKS];
+    for (int i = 0; i < 16; i++) {
+        ctr[i] = counter[i];
+    }
+
+    for (int i = 0; i < len; i += 16 * CTR_BATCH_BLOCKS) {
+        int nblocks = (len - i) / 16;
+        if (nblocks > CTR_BATCH_BLOCKS) {
+            nblocks = CTR_BATCH_BLOCKS;
+        }
+        for (int b = 0; b < nblocks; b++) {
+            for (int j = 0; j < 16; j++) {
+                keystream[16 * b + j] = ctr[j];
+            }
+            incrementCounter(ctr);
+        }
+        encryptBlocks(keystream, keystream, nblocks, key);
+        for (int j = 0; j < 16 * nblocks; j++) {
+            output[i + j] = data[i + j] ^ keystream[j];
+        }
+    }
+}
+
+// CTR over len bytes (whole blocks) from counter, which is advanced past
+// them. Each chunk derives its own starting counter, so chunks run
+// independently on the worker pool.
+void ctrBulk(const AesEncryptKey* key, uint8_t* counter, const uint8_t* data, uint8_t* output, int len) {
+    int nchunks = (len + AES_PARALLEL_CHUNK - 1) / AES_PARALLEL_CHUNK;
+    parallelFor(nchunks, [&](int c) {
+        int begin = c * AES_PARALLEL_CHUNK;
+        int n = (len - begin < AES_PARALLEL_CHUNK) ? len - begin : AES_PARALLEL_CHUNK;
+        uint8_t chunkCounter[16];
+        for (int j = 0; j < 16; j++) {
+            chunkCounter[j] = counter[j];
+        }
+        addCounter(chunkCounter, (uint64_t)(begin / 16));
+        ctrXorBlocks(key, chunkCounter, data + begin, output + begin, n);
+    });
+    addCounter(counter, (uint64_t)(len / 16));
+}
+
+// --- AES-XTS (IEEE 1619) ---
+
+// Blocks gathered from one or more sectors per kernel call. Short sectors
+// share a batch, so the cipher stays busy even for 16- or 32-byte records.
+#define XTS_BATCH_BLOCKS 32
+
+struct XtsKeys {
+    AesEncryptKey tweakKey;
+    AesEncryptKey dataKey;
+    AesDecryptKey dataDecKey;
+    bool encrypt;
+};
+
+static inline uint64_t loadLe64(const uint8_t* p) {
+    uint64_t w = 0;
+    for (int i = 7; i >= 0; i--) {
+        w = (w << 8) | p[i];
+    }
+    return w;
+}
+
+static inline void storeLe64(uint8_t* p, uint64_t w) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(w >> (8 * i));
+    }
+}
+
+// Tweak held as little-endian 64-bit halves; multiply by alpha (x) in
+// GF(2^128) modulo x^128 + x^7 + x^2 + x + 1
+struct XtsTweak {
+    uint64_t lo, hi;
+};
+
+static inline void xtsMulAlpha(XtsTweak* t) {
+    uint64_t carry = t->hi >> 63;
+    t->hi = (t->hi << 1) | (t->lo >> 63);
+    t->lo = (t->lo << 1) ^ (0x87 & (0 - carry));
 }
 
+static inline void xtsStoreTweak(uint8_t* p, const XtsTweak* t) {
+    storeLe64(p, t->lo);
+    storeLe64(p + 8, t->hi);
+}
+
+static inline void xtsCipherBlocks(const XtsKeys* keys, uint8_t* blocks, int nblocks) {
+    if (keys->encrypt) {
+        encryptBlocks(blocks, blocks, nblocks, &keys->dataKey);
+    } else {
+        decryptBlocks(blocks, blocks, nblocks, &keys->dataDecKey);
+    }
+}
+
+// One block: out = E(in ^ T) ^ T (or D for decryption)
+static void xtsBlock(const XtsKeys* keys, const uint8_t* in, uint8_t* out, const XtsTweak* t) {
+    uint8_t tweak[16];
+    uint8_t block[16];
+    xtsStoreTweak(tweak, t);
+    for (int j = 0; j < 16; j++) {
+        block[j] = in[j] ^ tweak[j];
+    }
+    xtsCipherBlocks(keys, block, 1);
+    for (int j = 0; j < 16; j++) {
+        out[j] = block[j] ^ tweak[j];
+    }
+}
+
+// Last full block plus a partial block of tailLen bytes (ciphertext
+// stealing). t is the tweak for the last full block.
+static void xtsStealTail(const XtsKeys* keys, const uint8_t* in, uint8_t* out, int tailLen, XtsTweak t) {
+    XtsTweak next = t;
+    xtsMulAlpha(&next);
+    uint8_t cc[16];
+    uint8_t pp[16];
+    // Decryption consumes the two tweaks in swapped order
+    xtsBlock(keys, in, cc, keys->encrypt ? &t : &next);
+    for (int j = 0; j < 16; j++) {
+        pp[j] = (j < tailLen) ? in[16 + j] : cc[j];
+    }
+    for (int j = 0; j < tailLen; j++) {
+        out[16 + j] = cc[j];
+    }
+    xtsBlock(keys, pp, out, keys->encrypt ? &next : &t);
+}
+
+// Encrypt or decrypt nsectors sectors of sectorSize bytes. Sector i is at
+// data + i * sectorSize and uses data unit number sectorNumbers[i]. Initial
+// tweaks are computed XTS_BATCH_BLOCKS sectors at a time, and the main pass
+// packs blocks from consecutive sectors into shared kernel calls.
+void xtsSectors(const XtsKeys* keys, const uint8_t* data, uint8_t* output, int sectorSize, int nsectors,
+                const uint64_t* sectorNumbers) {
+    int tailLen = sectorSize % 16;
+    // Blocks handled by the batched pass; with stealing the last full block
+    // goes through xtsStealTail() instead
+    int mainBlocks = sectorSize / 16 - (tailLen ? 1 : 0);
+
+    uint8_t buffer[16 * XTS_BATCH_BLOCKS];
+    uint8_t tweaks[16 * XTS_BATCH_BLOCKS];
+    int offsets[XTS_BATCH_BLOCKS];
+
+    for (int s0 = 0; s0 < nsectors; s0 += XTS_BATCH_BLOCKS) {
+        int count = (nsectors - s0 < XTS_BATCH_BLOCKS) ? nsectors - s0 : XTS_BATCH_BLOCKS;
+        XtsTweak sectorTweaks[XTS_BATCH_BLOCKS];
+        for (int s = 0; s < count; s++) {
+            storeLe64(tweaks + 16 * s, sectorNumbers[s0 + s]);
+            storeLe64(tweaks + 16 * s + 8, 0);
+        }
+        encryptBlocks(tweaks, tweaks, count, &keys->tweakKey);
+        for (int s = 0; s < count; s++) {
+            sectorTweaks[s].lo = loadLe64(tweaks + 16 * s);
+            sectorTweaks[s].hi = loadLe64(tweaks + 16 * s + 8);
+        }
+
+        int fill = 0;
+        for (int s = 0; s < count; s++) {
+            int base = (s0 + s) * sectorSize;
+            XtsTweak t = sectorTweaks[s];
+            for (int b = 0; b < mainBlocks; b++) {
+                int offset = base + 16 * b;
+                xtsStoreTweak(tweaks + 16 * fill, &t);
+                for (int j = 0; j < 16; j++) {
+                    buffer[16 * fill + j] = data[offset + j] ^ tweaks[16 * fill + j];
+                }
+                offsets[fill++] = offset;
+                xtsMulAlpha(&t);
+
+                if (fill == XTS_BATCH_BLOCKS) {
+                    xtsCipherBlocks(keys, buffer, fill);
+                    for (int k = 0; k < fill; k++) {
+                        for (int j = 0; j < 16; j++) {
+                            output[offsets[k] + j] = buffer[16 * k + j] ^ tweaks[16 * k + j];
+                        }
+                    }
+                    fill = 0;
+                }
+            }
+            if (tailLen) {
+                int offset = base + 16 * mainBlocks;
+                xtsStealTail(keys, data + offset, output + offset, tailLen, t);
+            }
+        }
+
+        xtsCipherBlocks(keys, buffer, fill);
+        for (int k = 0; k < fill; k++) {
+            for (int j = 0; j < 16; j++) {
+                output[offsets[k] + j] = buffer[16 * k + j] ^ tweaks[16 * k + j];
+            }
+        }
+    }
+}
+
+// --- AES-GCM ---
+
+// Per-key GHASH table for Shoup's 4-bit method: (HH[i], HL[i]) = i * H,
+// with 128-bit values held as big-endian high/low 64-bit halves
+struct GhashKey {
+    uint64_t HH[16];
+    uint64_t HL[16];
+#ifdef AES_NATIVE_X86
+    bool clmul;
+    uint8_t H[16];
+#endif
+};
+
+// Reduction constants for the 4 bits shifted out of Z on each step
+static const uint64_t ghashLast4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static inline uint64_t loadWord64(const uint8_t* p) {
+    return ((uint64_t)loadWord(p) << 32) | loadWord(p + 4);
+}
+
+static inline void storeWord64(uint8_t* p, uint64_t w) {
+    storeWord(p, (uint32_t)(w >> 32));
+    storeWord(p + 4, (uint32_t)w);
+}
+
+void ghashInit(GhashKey* gk, const uint8_t* H) {
+#ifdef AES_NATIVE_X86
+    gk->clmul = cpuFeatures.pclmul;
+    for (int i = 0; i < 16; i++) {
+        gk->H[i] = H[i];
+    }
+#endif
+    uint64_t vh = loadWord64(H);
+    uint64_t vl = loadWord64(H + 8);
+
+    gk->HH[0] = 0;
+    gk->HL[0] = 0;
+    gk->HH[8] = vh;
+    gk->HL[8] = vl;
+
+    // 4, 2, 1: successive multiplications by x (a right shift in GCM's bit order)
+    for (int i = 4; i > 0; i >>= 1) {
+        uint64_t T = (vl & 1) * 0xe100000000000000ull;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ T;
+        gk->HH[i] = vh;
+        gk->HL[i] = vl;
+    }
+
+    // The other entries are XOR combinations of the powers above
+    for (int i = 2; i <= 8; i *= 2) {
+        for (int j = 1; j < i; j++) {
+            gk->HH[i + j] = gk->HH[i] ^ gk->HH[j];
+            gk->HL[i + j] = gk->HL[i] ^ gk->HL[j];
+        }
+    }
+}
+
+// x = x * H in GF(2^128), one nibble at a time
+void ghashMult(const GhashKey* gk, uint8_t* x) {
+    uint8_t lo = x[15] & 0xf;
+    uint64_t zh = gk->HH[lo];
+    uint64_t zl = gk->HL[lo];
+
+    for (int i = 15; i >= 0; i--) {
+        lo = x[i] & 0xf;
+        uint8_t hi = x[i] >> 4;
+        uint8_t rem;
+
+        if (i != 15) {
+            rem = (uint8_t)zl & 0xf;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (ghashLast4[rem] << 48) ^ gk->HH[lo];
+            zl ^= gk->HL[lo];
+        }
+
+        rem = (uint8_t)zl & 0xf;
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (ghashLast4[rem] << 48) ^ gk->HH[hi];
+        zl ^= gk->HL[hi];
+    }
+
+    storeWord64(x, zh);
+    storeWord64(x + 8, zl);
+}
+
+// Absorb len bytes into the GHASH accumulator y, zero-padding the last block
+void ghashUpdate(const GhashKey* gk, uint8_t* y, const uint8_t* data, int len) {
+#ifdef AES_NATIVE_X86
+    if (gk->clmul) {
+        niGhashUpdate(gk->H, y, data, len);
+        return;
+    }
+#endif
+    for (int i = 0; i < len; i += 16) {
+        int n = (len - i < 16) ? len - i : 16;
+        for (int j = 0; j < n; j++) {
+            y[j] ^= data[i + j];
+        }
+        ghashMult(gk, y);
+    }
+}
+
+// Absorb the final [len(A)]64 || [len(C)]64 block (lengths in bits)
+void ghashLengths(const GhashKey* gk, uint8_t* y, uint64_t aadLen, uint64_t dataLen) {
+    uint8_t block[16];
+    storeWord64(block, aadLen * 8);
+    storeWord64(block + 8, dataLen * 8);
+    ghashUpdate(gk, y, block, 16);
+}
+
+// Increment the low 32 bits of a GCM counter block
+static inline void incrementCounter32(uint8_t* counter) {
+    for (int i = 15; i >= 12; i--) {
+        if (++counter[i] != 0) break;
+    }
+}
+
+// Blocks of keystream generated and hashed per step of the GCM pass
+#define GCM_CHUNK_BLOCKS 8
+
 extern "C" {
 
 EMSCRIPTEN_KEEPALIVE
@@ -293,39 +1454,375 @@ int process_aes(const uint8_t* data, int data_len, const uint8_t* key, uint8_t*
         return 0; // Error: data length not multiple of 16
     }
     
-    uint8_t extendedKey[176]; // 16 * (10 + 1) = 176 bytes
-    extendKey((uint8_t*)key, extendedKey);
+    processEcb<4>(data, data_len, key, output, encrypt_mode);
     
-    // Process data in 16-byte (128-bit) chunks
-    for (int i = 0; i < data_len; i += 16) {
-        // Additional bounds check
-        if (i + 16 > data_len) {
-            return 0; // Error: would exceed bounds
-        }
-        
-        uint8_t state[16];
-        
-        // Copy input block to state
-        for (int j = 0; j < 16; j++) {
-            if (i + j < data_len) {
-                state[j] = data[i + j];
-            } else {
-                state[j] = 0; // Padding for incomplete blocks
+    return 1; // Success
+}
+
+// ECB with a 16-, 24- or 32-byte key (AES-128/192/256); otherwise as process_aes
+EMSCRIPTEN_KEEPALIVE
+int process_aes_keylen(const uint8_t* data, int data_len, const uint8_t* key, int key_len, uint8_t* output, bool encrypt_mode) {
+    // Safety checks
+    if (!data || !key || !output) {
+        return 0; // Error: null pointers
+    }
+
+    if (data_len <= 0 || data_len % 16 != 0) {
+        return 0; // Error: invalid data length
+    }
+
+    switch (key_len) {
+        case 16: processEcb<4>(data, data_len, key, output, encrypt_mode); break;
+        case 24: processEcb<6>(data, data_len, key, output, encrypt_mode); break;
+        case 32: processEcb<8>(data, data_len, key, output, encrypt_mode); break;
+        default: return 0; // Error: unsupported key length
+    }
+
+    return 1; // Success
+}
+
+// AES-128-GCM with a 16-byte tag. When encrypting, output receives the
+// ciphertext and tag receives the tag. When decrypting, tag is the expected
+// tag; on mismatch output is wiped and 0 is returned.
+EMSCRIPTEN_KEEPALIVE
+int process_aes_gcm(const uint8_t* data, int data_len, const uint8_t* key, const uint8_t* iv, int iv_len,
+                    const uint8_t* aad, int aad_len, uint8_t* output, uint8_t* tag, bool encrypt_mode) {
+    // Safety checks
+    if (!key || !iv || !tag || (data_len > 0 && (!data || !output)) || (aad_len > 0 && !aad)) {
+        return 0; // Error: null pointers
+    }
+
+    if (data_len < 0 || aad_len < 0 || iv_len <= 0) {
+        return 0; // Error: invalid lengths
+    }
+
+    AesEncryptKey ek;
+    setupEncryptKey(key, 16, &ek);
+
+    // H = E(K, 0^128)
+    GhashKey gk;
+    uint8_t H[16] = {0};
+    encryptBlocks(H, H, 1, &ek);
+    ghashInit(&gk, H);
+
+    // Pre-counter block J0
+    uint8_t J0[16] = {0};
+    if (iv_len == 12) {
+        for (int i = 0; i < 12; i++) {
+            J0[i] = iv[i];
+        }
+        J0[15] = 1;
+    } else {
+        ghashUpdate(&gk, J0, iv, iv_len);
+        ghashLengths(&gk, J0, 0, (uint64_t)iv_len);
+    }
+
+    uint8_t y[16] = {0};
+    ghashUpdate(&gk, y, aad, aad_len);
+
+    // One pass: encrypt a chunk of counter blocks, XOR, and hash the
+    // ciphertext while it is still in cache
+    uint8_t counter[16];
+    for (int i = 0; i < 16; i++) {
+        counter[i] = J0[i];
+    }
+    uint8_t keystream[16 * GCM_CHUNK_BLOCKS];
+    for (int i = 0; i < data_len; i += 16 * GCM_CHUNK_BLOCKS) {
+        int n = data_len - i;
+        if (n > 16 * GCM_CHUNK_BLOCKS) {
+            n = 16 * GCM_CHUNK_BLOCKS;
+        }
+        int nblocks = (n + 15) / 16;
+        for (int b = 0; b < nblocks; b++) {
+            incrementCounter32(counter);
+            for (int j = 0; j < 16; j++) {
+                keystream[16 * b + j] = counter[j];
             }
         }
-        
+        encryptBlocks(keystream, keystream, nblocks, &ek);
+
+        if (!encrypt_mode) {
+            ghashUpdate(&gk, y, data + i, n);
+        }
+        for (int j = 0; j < n; j++) {
+            output[i + j] = data[i + j] ^ keystream[j];
+        }
         if (encrypt_mode) {
-            encrypt(state, extendedKey);
-        } else {
-            decrypt(state, extendedKey);
+            ghashUpdate(&gk, y, output + i, n);
         }
-        
-        // Copy state to output
-        for (int j = 0; j < 16; j++) {
-            output[i + j] = state[j];
+    }
+
+    ghashLengths(&gk, y, (uint64_t)aad_len, (uint64_t)data_len);
+
+    // T = E(K, J0) ^ S
+    uint8_t fullTag[16];
+    encryptBlocks(J0, fullTag, 1, &ek);
+    for (int i = 0; i < 16; i++) {
+        fullTag[i] ^= y[i];
+    }
+
+    if (encrypt_mode) {
+        for (int i = 0; i < 16; i++) {
+            tag[i] = fullTag[i];
         }
+        return 1; // Success
     }
-    
+
+    // Constant-time tag comparison
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; i++) {
+        diff |= fullTag[i] ^ tag[i];
+    }
+    if (diff != 0) {
+        for (int i = 0; i < data_len; i++) {
+            output[i] = 0;
+        }
+        return 0; // Error: authentication failed
+    }
+
+    return 1; // Success
+}
+
+// Start a CTR stream; iv is the initial 16-byte counter block.
+// Returns a state handle, or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+AesCtrState* aes_ctr_init(const uint8_t* key, const uint8_t* iv) {
+    if (!key || !iv) {
+        return 0; // Error: null pointers
+    }
+
+    AesCtrState* st = new (std::nothrow) AesCtrState;
+    if (!st) {
+        return 0; // Error: out of memory
+    }
+    setupEncryptKey(key, 16, &st->key);
+    for (int i = 0; i < 16; i++) {
+        st->counter[i] = iv[i];
+    }
+    st->keystreamPos = 16 * CTR_BATCH_BLOCKS; // refill on first use
+    return st;
+}
+
+// Encrypt or decrypt (the same operation in CTR) the next data_len bytes of
+// the stream. Any length is accepted; output may alias data.
+EMSCRIPTEN_KEEPALIVE
+int aes_ctr_update(AesCtrState* st, const uint8_t* data, int data_len, uint8_t* output) {
+    if (!st || (data_len > 0 && (!data || !output))) {
+        return 0; // Error: null pointers
+    }
+
+    if (data_len < 0) {
+        return 0; // Error: invalid data length
+    }
+
+    const int batchBytes = 16 * CTR_BATCH_BLOCKS;
+    int i = 0;
+    while (i < data_len) {
+        if (st->keystreamPos == batchBytes) {
+            // Block-aligned bulk data skips the buffer
+            int bulk = (data_len - i) & ~15;
+            if (bulk > 0) {
+                ctrBulk(&st->key, st->counter, data + i, output + i, bulk);
+                i += bulk;
+                continue;
+            }
+            refillKeystream(st);
+        }
+        int n = batchBytes - st->keystreamPos;
+        if (n > data_len - i) {
+            n = data_len - i;
+        }
+        const uint8_t* ks = st->keystream + st->keystreamPos;
+        for (int j = 0; j < n; j++) {
+            output[i + j] = data[i + j] ^ ks[j];
+        }
+        st->keystreamPos += n;
+        i += n;
+    }
+
+    return 1; // Success
+}
+
+// End the stream and release its state
+EMSCRIPTEN_KEEPALIVE
+int aes_ctr_final(AesCtrState* st) {
+    if (!st) {
+        return 0; // Error: null pointer
+    }
+
+    volatile uint8_t* wipe = (volatile uint8_t*)st;
+    for (unsigned i = 0; i < sizeof(AesCtrState); i++) {
+        wipe[i] = 0;
+    }
+    delete st;
+    return 1; // Success
+}
+
+// AES-XTS over num_sectors independent sectors of sector_size bytes each
+// (at least 16; a partial final block uses ciphertext stealing). Sector i
+// sits at data + i * sector_size and is tweaked by sector_numbers[i], so any
+// sector can later be re-encrypted on its own. key is Key1 || Key2: 32 bytes
+// for AES-128-XTS or 64 bytes for AES-256-XTS. output may alias data.
+EMSCRIPTEN_KEEPALIVE
+int process_aes_xts_batch(const uint8_t* data, int sector_size, int num_sectors, const uint64_t* sector_numbers,
+                          const uint8_t* key, int key_len, uint8_t* output, bool encrypt_mode) {
+    // Safety checks
+    if (!data || !sector_numbers || !key || !output) {
+        return 0; // Error: null pointers
+    }
+
+    if (sector_size < 16 || num_sectors <= 0 || (int64_t)sector_size * num_sectors > 0x7fffffff) {
+        return 0; // Error: invalid sector size or count
+    }
+
+    if (key_len != 32 && key_len != 64) {
+        return 0; // Error: invalid key length
+    }
+
+    // IEEE 1619-2018 requires the two halves of the key to differ
+    int half = key_len / 2;
+    bool sameHalves = true;
+    for (int i = 0; i < half; i++) {
+        sameHalves = sameHalves && key[i] == key[half + i];
+    }
+    if (sameHalves) {
+        return 0; // Error: Key1 == Key2
+    }
+
+    XtsKeys xts;
+    XtsKeys* keys = &xts;
+    keys->encrypt = encrypt_mode;
+    setupEncryptKey(key + half, half, &keys->tweakKey);
+    if (encrypt_mode) {
+        setupEncryptKey(key, half, &keys->dataKey);
+    } else {
+        setupDecryptKey(key, half, &keys->dataDecKey);
+    }
+
+    // Whole sectors per work item, about AES_PARALLEL_CHUNK bytes each
+    int perItem = AES_PARALLEL_CHUNK / sector_size;
+    if (perItem < 1) {
+        perItem = 1;
+    }
+    int nitems = (num_sectors + perItem - 1) / perItem;
+    parallelFor(nitems, [&](int c) {
+        int first = c * perItem;
+        int count = (num_sectors - first < perItem) ? num_sectors - first : perItem;
+        int64_t offset = (int64_t)first * sector_size;
+        xtsSectors(keys, data + offset, output + offset, sector_size, count, sector_numbers + first);
+    });
+
+    volatile uint8_t* wipe = (volatile uint8_t*)keys;
+    for (unsigned i = 0; i < sizeof(XtsKeys); i++) {
+        wipe[i] = 0;
+    }
+
+    return 1; // Success
+}
+
+// AES-XTS over a single sector (data unit) of data_len bytes with the given
+// sector number; see process_aes_xts_batch()
+EMSCRIPTEN_KEEPALIVE
+int process_aes_xts(const uint8_t* data, int data_len, uint64_t sector_number, const uint8_t* key, int key_len,
+                    uint8_t* output, bool encrypt_mode) {
+    return process_aes_xts_batch(data, data_len, 1, &sector_number, key, key_len, output, encrypt_mode);
+}
+
+// ECB, CBC, CFB, OFB or CTR (mode 0-4, see block_modes.h) with a 16-, 24-
+// or 32-byte key. ECB and CBC need a multiple of 16 bytes; the other modes
+// take any length. iv is 16 bytes (ignored for ECB) and is updated in place
+// so a further call continues the same message. output may alias data.
+EMSCRIPTEN_KEEPALIVE
+int process_aes_mode(const uint8_t* data, int data_len, const uint8_t* key, int key_len, uint8_t* iv, int mode,
+                     uint8_t* output, bool encrypt_mode) {
+    // Safety checks
+    if (!data || !key || !output || (!iv && mode != MODE_ECB)) {
+        return 0; // Error: null pointers
+    }
+
+    if (data_len <= 0) {
+        return 0; // Error: invalid data length
+    }
+
+    AesBlockCipher cipher;
+    if (!setupEncryptKey(key, key_len, &cipher.ek)) {
+        return 0; // Error: invalid key length
+    }
+    if (modeUsesDecrypt(mode, encrypt_mode)) {
+        setupDecryptKey(key, key_len, &cipher.dk);
+    }
+
+    if (!processMode(cipher, mode, iv, data, output, data_len, encrypt_mode)) {
+        return 0; // Error: unknown mode or data length not a multiple of 16
+    }
+
+    return 1; // Success
+}
+
+// Expand a 16-, 24- or 32-byte key once, for both directions, into a
+// context for aes_context_process(). Returns a handle, or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+AesBlockCipher* aes_create_context(const uint8_t* key, int key_len) {
+    if (!key) {
+        return 0; // Error: null pointer
+    }
+
+    AesBlockCipher* ctx = new (std::nothrow) AesBlockCipher;
+    if (!ctx) {
+        return 0; // Error: out of memory
+    }
+    if (!setupEncryptKey(key, key_len, &ctx->ek)) {
+        delete ctx;
+        return 0; // Error: invalid key length
+    }
+    setupDecryptKey(key, key_len, &ctx->dk);
+    return ctx;
+}
+
+// process_aes_mode() with the schedules cached in ctx; no key setup runs
+EMSCRIPTEN_KEEPALIVE
+int aes_context_process(const AesBlockCipher* ctx, const uint8_t* data, int data_len, uint8_t* iv, int mode,
+                        uint8_t* output, bool encrypt_mode) {
+    // Safety checks
+    if (!ctx || !data || !output || (!iv && mode != MODE_ECB)) {
+        return 0; // Error: null pointers
+    }
+
+    if (data_len <= 0) {
+        return 0; // Error: invalid data length
+    }
+
+    // Whole CTR blocks take the parallel path; processMode() finishes the tail
+    if (mode == MODE_CTR) {
+        int bulk = data_len & ~15;
+        ctrBulk(&ctx->ek, iv, data, output, bulk);
+        data += bulk;
+        output += bulk;
+        data_len -= bulk;
+        if (data_len == 0) {
+            return 1; // Success
+        }
+    }
+
+    if (!processMode(*ctx, mode, iv, data, output, data_len, encrypt_mode)) {
+        return 0; // Error: unknown mode or data length not a multiple of 16
+    }
+
+    return 1; // Success
+}
+
+// Wipe and release a context from aes_create_context()
+EMSCRIPTEN_KEEPALIVE
+int aes_destroy_context(AesBlockCipher* ctx) {
+    if (!ctx) {
+        return 0; // Error: null pointer
+    }
+
+    volatile uint8_t* wipe = (volatile uint8_t*)ctx;
+    for (unsigned i = 0; i < sizeof(AesBlockCipher); i++) {
+        wipe[i] = 0;
+    }
+    delete ctx;
     return 1; // Success
 }
 
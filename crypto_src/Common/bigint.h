@@ -0,0 +1,803 @@
+// crypto_src/Common/bigint.h
+// Fixed-capacity unsigned big integers for the public-key modules. A BigInt
+// is a little-endian array of 32-bit limbs sized for 4096-bit operands and
+// their double-width products, so no operation allocates. 32-bit limbs keep
+// every partial product inside a native 64-bit multiply, which is the widest
+// WASM has.
+//
+// Modular exponentiation runs in Montgomery form (MontContext) for odd
+// moduli, with schoolbook multiplication for small operands and Karatsuba
+// from BIGINT_KARATSUBA_LIMBS limbs up. montPower() is a sliding-window
+// exponentiation for public exponents; montPowerConstTime() a fixed-window
+// one for secret exponents.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Largest modulus in bits
+#define BIGINT_MAX_BITS 4096
+// Limbs in a BigInt: a full product of two maximum-size operands plus slack
+#define BIGINT_LIMBS (2 * BIGINT_MAX_BITS / 32 + 2)
+// Limbs in a Montgomery residue
+#define MONT_LIMBS (BIGINT_MAX_BITS / 32)
+// Operand size in limbs from which multiplication and squaring split
+// Karatsuba-style; below it schoolbook is faster
+#ifndef BIGINT_KARATSUBA_LIMBS
+#define BIGINT_KARATSUBA_LIMBS 24
+#endif
+
+struct BigInt {
+    uint32_t limb[BIGINT_LIMBS];
+    int size; // limbs in use; limb[size - 1] != 0, and zero has size 0
+};
+
+// --- Limb-array primitives ---
+
+// r = a + b over n limbs; returns the carry out. r may alias a or b.
+static inline uint32_t limbAdd(uint32_t* r, const uint32_t* a, const uint32_t* b, int n) {
+    uint64_t carry = 0;
+    for (int i = 0; i < n; i++) {
+        carry += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// r = a - b over n limbs; returns the borrow out. r may alias a or b.
+static inline uint32_t limbSub(uint32_t* r, const uint32_t* a, const uint32_t* b, int n) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t t = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)t;
+        borrow = t >> 63;
+    }
+    return (uint32_t)borrow;
+}
+
+// x[0..xn) += y[0..yn) with yn <= xn; returns the carry out of x
+static inline uint32_t limbAddInto(uint32_t* x, int xn, const uint32_t* y, int yn) {
+    uint64_t carry = limbAdd(x, x, y, yn);
+    for (int i = yn; i < xn; i++) {
+        carry += x[i];
+        x[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// x[0..xn) -= y[0..yn) with yn <= xn; returns the borrow out of x
+static inline uint32_t limbSubFrom(uint32_t* x, int xn, const uint32_t* y, int yn) {
+    uint64_t borrow = limbSub(x, x, y, yn);
+    for (int i = yn; i < xn; i++) {
+        uint64_t t = (uint64_t)x[i] - borrow;
+        x[i] = (uint32_t)t;
+        borrow = t >> 63;
+    }
+    return (uint32_t)borrow;
+}
+
+// r[0..an+bn) = a * b. r must not alias a or b.
+static inline void limbMulSchoolbook(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+    for (int j = 0; j < bn; j++) r[j] = 0;
+    for (int i = 0; i < an; i++) {
+        uint64_t ai = a[i];
+        uint64_t carry = 0;
+        for (int j = 0; j < bn; j++) {
+            uint64_t t = ai * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        r[i + bn] = (uint32_t)carry;
+    }
+}
+
+// r[0..2n) = a * a: each cross product once, doubled, plus the squares
+static inline void limbSqrSchoolbook(uint32_t* r, const uint32_t* a, int n) {
+    for (int i = 0; i < 2 * n; i++) r[i] = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t ai = a[i];
+        uint64_t carry = 0;
+        for (int j = i + 1; j < n; j++) {
+            uint64_t t = ai * a[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        r[i + n] = (uint32_t)carry;
+    }
+    uint32_t top = 0;
+    for (int i = 0; i < 2 * n; i++) {
+        uint32_t w = r[i];
+        r[i] = (w << 1) | top;
+        top = w >> 31;
+    }
+    uint64_t carry = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t sq = (uint64_t)a[i] * a[i];
+        uint64_t t = (uint64_t)r[2 * i] + (uint32_t)sq + carry;
+        r[2 * i] = (uint32_t)t;
+        t = (uint64_t)r[2 * i + 1] + (sq >> 32) + (t >> 32);
+        r[2 * i + 1] = (uint32_t)t;
+        carry = t >> 32;
+    }
+}
+
+// Scratch limbs limbMul()/limbSqr() need for n-limb operands
+#define BIGINT_SCRATCH_LIMBS(n) (4 * (n) + 64)
+
+// r[0..2n) = a * b for n-limb operands. Karatsuba splits a = a1:a0 and
+// b = b1:b0 and forms the middle product from (a0 + a1)(b0 + b1), trading
+// one of the four half-size products for a few additions.
+static void limbMul(uint32_t* r, const uint32_t* a, const uint32_t* b, int n, uint32_t* scratch) {
+    if (n < BIGINT_KARATSUBA_LIMBS) {
+        limbMulSchoolbook(r, a, n, b, n);
+        return;
+    }
+    int h = n / 2;
+    int m = n - h;
+    uint32_t* sa = scratch;
+    uint32_t* sb = sa + m + 1;
+    uint32_t* mid = sb + m + 1;
+    uint32_t* next = mid + 2 * (m + 1);
+
+    limbMul(r, a, b, h, next);
+    limbMul(r + 2 * h, a + h, b + h, m, next);
+    for (int i = 0; i < m; i++) {
+        sa[i] = a[h + i];
+        sb[i] = b[h + i];
+    }
+    sa[m] = limbAddInto(sa, m, a, h);
+    sb[m] = limbAddInto(sb, m, b, h);
+    limbMul(mid, sa, sb, m + 1, next);
+    limbSubFrom(mid, 2 * (m + 1), r, 2 * h);
+    limbSubFrom(mid, 2 * (m + 1), r + 2 * h, 2 * m);
+    limbAddInto(r + h, 2 * n - h, mid, 2 * m + 1);
+}
+
+// r[0..2n) = a * a, Karatsuba-style like limbMul()
+static void limbSqr(uint32_t* r, const uint32_t* a, int n, uint32_t* scratch) {
+    if (n < BIGINT_KARATSUBA_LIMBS) {
+        limbSqrSchoolbook(r, a, n);
+        return;
+    }
+    int h = n / 2;
+    int m = n - h;
+    uint32_t* sa = scratch;
+    uint32_t* mid = sa + m + 1;
+    uint32_t* next = mid + 2 * (m + 1);
+
+    limbSqr(r, a, h, next);
+    limbSqr(r + 2 * h, a + h, m, next);
+    for (int i = 0; i < m; i++) {
+        sa[i] = a[h + i];
+    }
+    sa[m] = limbAddInto(sa, m, a, h);
+    limbSqr(mid, sa, m + 1, next);
+    limbSubFrom(mid, 2 * (m + 1), r, 2 * h);
+    limbSubFrom(mid, 2 * (m + 1), r + 2 * h, 2 * m);
+    limbAddInto(r + h, 2 * n - h, mid, 2 * m + 1);
+}
+
+// --- BigInt basics ---
+
+static inline void bigTrim(BigInt& a) {
+    while (a.size > 0 && a.limb[a.size - 1] == 0) a.size--;
+}
+
+static inline void bigSetU64(BigInt& a, uint64_t v) {
+    a.limb[0] = (uint32_t)v;
+    a.limb[1] = (uint32_t)(v >> 32);
+    a.size = 2;
+    bigTrim(a);
+}
+
+static inline bool bigIsZero(const BigInt& a) {
+    return a.size == 0;
+}
+
+static inline bool bigIsOdd(const BigInt& a) {
+    return a.size > 0 && (a.limb[0] & 1);
+}
+
+static inline int bigBitLength(const BigInt& a) {
+    return a.size ? 32 * a.size - __builtin_clz(a.limb[a.size - 1]) : 0;
+}
+
+static inline int bigTestBit(const BigInt& a, int bit) {
+    int w = bit / 32;
+    return (w < a.size) ? (a.limb[w] >> (bit % 32)) & 1 : 0;
+}
+
+// Returns -1, 0 or 1 as a is less than, equal to or greater than b
+static inline int bigCompare(const BigInt& a, const BigInt& b) {
+    if (a.size != b.size) return (a.size < b.size) ? -1 : 1;
+    for (int i = a.size - 1; i >= 0; i--) {
+        if (a.limb[i] != b.limb[i]) return (a.limb[i] < b.limb[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+// r = a + b. Returns false if the sum does not fit.
+static inline bool bigAdd(const BigInt& a, const BigInt& b, BigInt& r) {
+    const BigInt& x = (a.size >= b.size) ? a : b;
+    const BigInt& y = (a.size >= b.size) ? b : a;
+    BigInt t;
+    int n = x.size;
+    for (int i = 0; i < n; i++) t.limb[i] = x.limb[i];
+    uint32_t carry = limbAddInto(t.limb, n, y.limb, y.size);
+    if (carry) {
+        if (n == BIGINT_LIMBS) return false;
+        t.limb[n++] = carry;
+    }
+    t.size = n;
+    r = t;
+    return true;
+}
+
+// r = a - b for a >= b
+static inline void bigSub(const BigInt& a, const BigInt& b, BigInt& r) {
+    BigInt t;
+    for (int i = 0; i < a.size; i++) t.limb[i] = a.limb[i];
+    limbSubFrom(t.limb, a.size, b.limb, b.size);
+    t.size = a.size;
+    bigTrim(t);
+    r = t;
+}
+
+// r = a * b. Returns false if the product does not fit. r must not alias a
+// or b.
+static inline bool bigMul(const BigInt& a, const BigInt& b, BigInt& r) {
+    if (a.size == 0 || b.size == 0) {
+        r.size = 0;
+        return true;
+    }
+    if (a.size + b.size > BIGINT_LIMBS) return false;
+    if (a.size == b.size && a.size <= MONT_LIMBS) {
+        uint32_t scratch[BIGINT_SCRATCH_LIMBS(MONT_LIMBS)];
+        if (&a == &b) limbSqr(r.limb, a.limb, a.size, scratch);
+        else limbMul(r.limb, a.limb, b.limb, a.size, scratch);
+    } else {
+        limbMulSchoolbook(r.limb, a.limb, a.size, b.limb, b.size);
+    }
+    r.size = a.size + b.size;
+    bigTrim(r);
+    return true;
+}
+
+// a = a * m + add. Returns false on overflow.
+static inline bool bigMulAddSmall(BigInt& a, uint32_t m, uint32_t add) {
+    uint64_t carry = add;
+    for (int i = 0; i < a.size; i++) {
+        carry += (uint64_t)a.limb[i] * m;
+        a.limb[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry) {
+        if (a.size == BIGINT_LIMBS) return false;
+        a.limb[a.size++] = (uint32_t)carry;
+    }
+    bigTrim(a);
+    return true;
+}
+
+// a = a - s for a >= s
+static inline void bigSubSmall(BigInt& a, uint32_t s) {
+    uint64_t borrow = s;
+    for (int i = 0; i < a.size && borrow; i++) {
+        uint64_t t = (uint64_t)a.limb[i] - borrow;
+        a.limb[i] = (uint32_t)t;
+        borrow = t >> 63;
+    }
+    bigTrim(a);
+}
+
+// a = a / d; returns a % d
+static inline uint32_t bigDivSmall(BigInt& a, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = a.size - 1; i >= 0; i--) {
+        uint64_t cur = (rem << 32) | a.limb[i];
+        a.limb[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    bigTrim(a);
+    return (uint32_t)rem;
+}
+
+// a % d without changing a
+static inline uint32_t bigModSmall(const BigInt& a, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = a.size - 1; i >= 0; i--) {
+        rem = ((rem << 32) | a.limb[i]) % d;
+    }
+    return (uint32_t)rem;
+}
+
+// r = a >> bits. r may alias a.
+static inline void bigShiftRight(const BigInt& a, int bits, BigInt& r) {
+    int words = bits / 32;
+    int s = bits % 32;
+    int n = a.size - words;
+    if (n <= 0) {
+        r.size = 0;
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        uint32_t lo = a.limb[i + words] >> s;
+        uint32_t hi = (s && i + words + 1 < a.size) ? a.limb[i + words + 1] << (32 - s) : 0;
+        r.limb[i] = lo | hi;
+    }
+    r.size = n;
+    bigTrim(r);
+}
+
+// q = a / b and r = a % b (either may be null). Knuth's algorithm D on
+// 32-bit digits. Returns false when b is zero.
+static bool bigDivMod(const BigInt& a, const BigInt& b, BigInt* q, BigInt* r) {
+    if (b.size == 0) return false;
+    if (bigCompare(a, b) < 0) {
+        if (r) *r = a;
+        if (q) q->size = 0;
+        return true;
+    }
+    if (b.size == 1) {
+        BigInt t = a;
+        uint32_t rem = bigDivSmall(t, b.limb[0]);
+        if (q) *q = t;
+        if (r) bigSetU64(*r, rem);
+        return true;
+    }
+
+    int n = b.size;
+    int m = a.size - n;
+    int s = __builtin_clz(b.limb[n - 1]);
+    uint32_t u[BIGINT_LIMBS + 1];
+    uint32_t v[BIGINT_LIMBS];
+    for (int i = n - 1; i > 0; i--) {
+        v[i] = (b.limb[i] << s) | (s ? b.limb[i - 1] >> (32 - s) : 0);
+    }
+    v[0] = b.limb[0] << s;
+    u[a.size] = s ? a.limb[a.size - 1] >> (32 - s) : 0;
+    for (int i = a.size - 1; i > 0; i--) {
+        u[i] = (a.limb[i] << s) | (s ? a.limb[i - 1] >> (32 - s) : 0);
+    }
+    u[0] = a.limb[0] << s;
+
+    for (int j = m; j >= 0; j--) {
+        // Estimate the quotient digit from the top two digits, then correct
+        uint64_t num = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+        uint64_t qhat = num / v[n - 1];
+        uint64_t rhat = num % v[n - 1];
+        while (qhat >> 32 || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+            qhat--;
+            rhat += v[n - 1];
+            if (rhat >> 32) break;
+        }
+
+        int64_t borrow = 0;
+        int64_t t;
+        for (int i = 0; i < n; i++) {
+            uint64_t p = qhat * v[i];
+            t = (int64_t)u[i + j] - borrow - (int64_t)(p & 0xffffffff);
+            u[i + j] = (uint32_t)t;
+            borrow = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)u[j + n] - borrow;
+        u[j + n] = (uint32_t)t;
+
+        if (t < 0) {
+            // qhat was one too large: add the divisor back
+            qhat--;
+            uint64_t carry = 0;
+            for (int i = 0; i < n; i++) {
+                carry += (uint64_t)u[i + j] + v[i];
+                u[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            u[j + n] += (uint32_t)carry;
+        }
+        if (q) q->limb[j] = (uint32_t)qhat;
+    }
+
+    if (q) {
+        q->size = m + 1;
+        bigTrim(*q);
+    }
+    if (r) {
+        for (int i = 0; i < n; i++) {
+            r->limb[i] = (u[i] >> s) | (s ? u[i + 1] << (32 - s) : 0);
+        }
+        r->size = n;
+        bigTrim(*r);
+    }
+    return true;
+}
+
+// r = a % m. Returns false when m is zero.
+static inline bool bigMod(const BigInt& a, const BigInt& m, BigInt& r) {
+    return bigDivMod(a, m, nullptr, &r);
+}
+
+// out = gcd(a, b) by Euclid's algorithm; gcd(0, b) = b
+static inline void bigGcd(const BigInt& a, const BigInt& b, BigInt& out) {
+    BigInt x = a;
+    BigInt y = b;
+    BigInt r;
+    while (!bigIsZero(y)) {
+        bigMod(x, y, r);
+        x = y;
+        y = r;
+    }
+    out = x;
+}
+
+// out = a^-1 mod m by the extended Euclidean algorithm. The Bezout
+// coefficient of a is kept reduced mod m, so it never goes negative.
+// Returns false unless gcd(a, m) = 1 and m > 1.
+static inline bool bigModInverse(const BigInt& a, const BigInt& m, BigInt& out) {
+    if (bigBitLength(m) < 2) return false;
+    BigInt r0 = m;
+    BigInt r1, t0, t1, q, r, qt, t;
+    bigMod(a, m, r1);
+    t0.size = 0;
+    bigSetU64(t1, 1);
+    // Invariant: t0 * a = r0 and t1 * a = r1 (mod m)
+    while (!bigIsZero(r1)) {
+        bigDivMod(r0, r1, &q, &r);
+        bigMul(q, t1, qt);
+        bigMod(qt, m, qt);
+        if (bigCompare(t0, qt) >= 0) {
+            bigSub(t0, qt, t);
+        } else {
+            bigAdd(t0, m, t);
+            bigSub(t, qt, t);
+        }
+        r0 = r1;
+        r1 = r;
+        t0 = t1;
+        t1 = t;
+    }
+    if (r0.size != 1 || r0.limb[0] != 1) return false;
+    out = t0;
+    return true;
+}
+
+// --- Conversions ---
+
+// Parse a decimal string, or hexadecimal with a 0x prefix. Returns false on
+// any other character or a value wider than BIGINT_MAX_BITS.
+static inline bool bigFromString(const char* s, BigInt& out) {
+    out.size = 0;
+    if (!s || !*s) return false;
+    int base = 10;
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        base = 16;
+        s += 2;
+        if (!*s) return false;
+    }
+    for (; *s; s++) {
+        int d;
+        if (*s >= '0' && *s <= '9') d = *s - '0';
+        else if (base == 16 && *s >= 'a' && *s <= 'f') d = *s - 'a' + 10;
+        else if (base == 16 && *s >= 'A' && *s <= 'F') d = *s - 'A' + 10;
+        else return false;
+        bigMulAddSmall(out, base, d);
+        if (bigBitLength(out) > BIGINT_MAX_BITS) return false;
+    }
+    return true;
+}
+
+// Decimal representation of a
+static inline std::string bigToString(const BigInt& a) {
+    if (a.size == 0) return "0";
+    BigInt t = a;
+    char digits[BIGINT_LIMBS * 10 + 1];
+    int pos = sizeof(digits) - 1;
+    digits[pos] = '\0';
+    while (t.size > 0) {
+        uint32_t chunk = bigDivSmall(t, 1000000000);
+        for (int i = 0; i < 9 && (t.size > 0 || chunk); i++) {
+            digits[--pos] = (char)('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    return std::string(digits + pos);
+}
+
+// Read a big-endian byte string. Returns false if it is wider than
+// BIGINT_MAX_BITS.
+static inline bool bigFromBytes(const uint8_t* p, int len, BigInt& out) {
+    while (len > 0 && *p == 0) {
+        p++;
+        len--;
+    }
+    if (len > BIGINT_MAX_BITS / 8) return false;
+    out.size = (len + 3) / 4;
+    for (int i = 0; i < out.size; i++) out.limb[i] = 0;
+    for (int i = 0; i < len; i++) {
+        int bit = 8 * (len - 1 - i);
+        out.limb[bit / 32] |= (uint32_t)p[i] << (bit % 32);
+    }
+    bigTrim(out);
+    return true;
+}
+
+// Write a as exactly len big-endian bytes. Returns false if it does not fit.
+static inline bool bigToBytes(const BigInt& a, uint8_t* p, int len) {
+    if (bigBitLength(a) > 8 * len) return false;
+    for (int i = 0; i < len; i++) {
+        int bit = 8 * (len - 1 - i);
+        p[i] = (bit / 32 < a.size) ? (uint8_t)(a.limb[bit / 32] >> (bit % 32)) : 0;
+    }
+    return true;
+}
+
+// --- Montgomery arithmetic ---
+//
+// For an odd k-limb modulus n and R = 2^(32k), a residue x is held as
+// xR mod n in k limbs. montMul() multiplies two residues and divides by R
+// with Montgomery's reduction (REDC), so chains of modular products never
+// divide by n.
+
+struct MontContext {
+    uint32_t n[MONT_LIMBS];
+    int k;              // limbs in n
+    uint32_t n0inv;     // -n^-1 mod 2^32
+    uint32_t rr[MONT_LIMBS];  // R^2 mod n, for converting into the domain
+    uint32_t one[MONT_LIMBS]; // R mod n, 1 in Montgomery form
+};
+
+// Prepare ctx for modulus n. Returns false unless n is odd, greater than 1
+// and at most BIGINT_MAX_BITS wide.
+static bool montSetup(MontContext& ctx, const BigInt& n) {
+    if (!bigIsOdd(n) || bigBitLength(n) < 2 || n.size > MONT_LIMBS) return false;
+    int k = n.size;
+    ctx.k = k;
+    for (int i = 0; i < k; i++) ctx.n[i] = n.limb[i];
+
+    // Newton's iteration doubles the correct low bits each step
+    uint32_t inv = 1;
+    for (int i = 0; i < 5; i++) inv *= 2 - n.limb[0] * inv;
+    ctx.n0inv = 0 - inv;
+
+    BigInt t;
+    BigInt r;
+    for (int i = 0; i < k; i++) t.limb[i] = 0;
+    t.limb[k] = 1;
+    t.size = k + 1;
+    bigMod(t, n, r);
+    for (int i = 0; i < k; i++) ctx.one[i] = (i < r.size) ? r.limb[i] : 0;
+    for (int i = 0; i < 2 * k; i++) t.limb[i] = 0;
+    t.limb[2 * k] = 1;
+    t.size = 2 * k + 1;
+    bigMod(t, n, r);
+    for (int i = 0; i < k; i++) ctx.rr[i] = (i < r.size) ? r.limb[i] : 0;
+    return true;
+}
+
+// out = t / R mod n for a 2k-limb t < nR; t is overwritten. The final subtraction is by mask, so the time taken does not depend on t.
+static inline void montReduce(const MontContext& ctx, uint32_t* t, uint32_t* out) {
+    int k = ctx.k;
+    uint64_t over = 0;
+    for (int i = 0; i < k; i++) {
+        uint64_t u = (uint32_t)(t[i] * ctx.n0inv);
+        uint64_t carry = 0;
+        for (int j = 0; j < k; j++) {
+            uint64_t s = u * ctx.n[j] + t[i + j] + carry;
+            t[i + j] = (uint32_t)s;
+            carry = s >> 32;
+        }
+        // The carry out of row i lands where row i + 1 ends
+        over += (uint64_t)t[i + k] + carry;
+        t[i + k] = (uint32_t)over;
+        over >>= 32;
+    }
+    // t[k..2k) + over * R is below 2n; subtract n unless that borrows
+    uint32_t diff[MONT_LIMBS];
+    uint32_t borrow = limbSub(diff, t + k, ctx.n, k);
+    uint32_t keep = 0 - (uint32_t)((borrow ^ 1) | (uint32_t)over);
+    for (int i = 0; i < k; i++) {
+        out[i] = (diff[i] & keep) | (t[k + i] & ~keep);
+    }
+}
+
+// out = a * b / R mod n. out may alias a or b.
+static inline void montMul(const MontContext& ctx, const uint32_t* a, const uint32_t* b, uint32_t* out) {
+    uint32_t t[2 * MONT_LIMBS];
+    uint32_t scratch[BIGINT_SCRATCH_LIMBS(MONT_LIMBS)];
+    limbMul(t, a, b, ctx.k, scratch);
+    montReduce(ctx, t, out);
+}
+
+// out = a * a / R mod n. out may alias a.
+static inline void montSqr(const MontContext& ctx, const uint32_t* a, uint32_t* out) {
+    uint32_t t[2 * MONT_LIMBS];
+    uint32_t scratch[BIGINT_SCRATCH_LIMBS(MONT_LIMBS)];
+    limbSqr(t, a, ctx.k, scratch);
+    montReduce(ctx, t, out);
+}
+
+// out = a + b mod n for a, b < n. Montgomery form is linear, so this adds
+// residues directly. out may alias a or b.
+static inline void montAdd(const MontContext& ctx, const uint32_t* a, const uint32_t* b, uint32_t* out) {
+    int k = ctx.k;
+    uint32_t sum[MONT_LIMBS];
+    uint32_t diff[MONT_LIMBS];
+    uint32_t carry = limbAdd(sum, a, b, k);
+    uint32_t borrow = limbSub(diff, sum, ctx.n, k);
+    // Keep the difference unless it borrowed without a carry to absorb it
+    uint32_t keep = 0 - (uint32_t)((borrow ^ 1) | carry);
+    for (int i = 0; i < k; i++) out[i] = (diff[i] & keep) | (sum[i] & ~keep);
+}
+
+// out = a - b mod n for a, b < n. out may alias a or b.
+static inline void montSub(const MontContext& ctx, const uint32_t* a, const uint32_t* b, uint32_t* out) {
+    int k = ctx.k;
+    uint32_t diff[MONT_LIMBS];
+    uint32_t fixed[MONT_LIMBS];
+    uint32_t borrow = limbSub(diff, a, b, k);
+    limbAdd(fixed, diff, ctx.n, k);
+    uint32_t keep = 0 - borrow;
+    for (int i = 0; i < k; i++) out[i] = (fixed[i] & keep) | (diff[i] & ~keep);
+}
+
+// out = x in Montgomery form; x may be any size
+static inline void montToDomain(const MontContext& ctx, const BigInt& x, uint32_t* out) {
+    BigInt n;
+    BigInt r;
+    for (int i = 0; i < ctx.k; i++) n.limb[i] = ctx.n[i];
+    n.size = ctx.k;
+    bigMod(x, n, r);
+    uint32_t a[MONT_LIMBS];
+    for (int i = 0; i < ctx.k; i++) a[i] = (i < r.size) ? r.limb[i] : 0;
+    montMul(ctx, a, ctx.rr, out);
+}
+
+// out = a Montgomery residue converted back to an ordinary integer
+static inline void montFromDomain(const MontContext& ctx, const uint32_t* a, BigInt& out) {
+    uint32_t t[2 * MONT_LIMBS];
+    for (int i = 0; i < ctx.k; i++) {
+        t[i] = a[i];
+        t[ctx.k + i] = 0;
+    }
+    montReduce(ctx, t, out.limb);
+    out.size = ctx.k;
+    bigTrim(out);
+}
+
+// Largest window for montPower() and montPowerConstTime(); the tables hold
+// 2^(w-1) and 2^w residues
+#define MONT_MAX_WINDOW 6
+#define MONT_CT_WINDOW 5
+
+// Sliding-window width for an exponent of `bits` bits, balancing the
+// table's precomputation against multiplications saved in the scan
+static inline int montWindowBits(int bits) {
+    return (bits > 671) ? 6 : (bits > 239) ? 5 : (bits > 79) ? 4 : (bits > 23) ? 3 : 1;
+}
+
+// out = base^exp with base and out in Montgomery form. Left-to-right
+// sliding window: the odd powers base, base^3, ..., base^(2^w - 1) are
+// precomputed, each run of up to w bits starting and ending in a 1 costs one
+// multiply, and zero bits cost only a squaring. The sequence of operations
+// follows the exponent's bits, so use montPowerConstTime() for secret
+// exponents. out may alias base.
+static inline void montPower(const MontContext& ctx, const uint32_t* base, const BigInt& exp, uint32_t* out) {
+    int k = ctx.k;
+    int bits = bigBitLength(exp);
+    if (bits == 0) {
+        for (int i = 0; i < k; i++) out[i] = ctx.one[i];
+        return;
+    }
+    int w = montWindowBits(bits);
+    uint32_t table[1 << (MONT_MAX_WINDOW - 1)][MONT_LIMBS];
+    uint32_t square[MONT_LIMBS];
+    for (int i = 0; i < k; i++) table[0][i] = base[i];
+    if (w > 1) {
+        montSqr(ctx, table[0], square);
+        for (int j = 1; j < (1 << (w - 1)); j++) {
+            montMul(ctx, table[j - 1], square, table[j]);
+        }
+    }
+
+    uint32_t acc[MONT_LIMBS];
+    bool started = false;
+    int i = bits - 1;
+    while (i >= 0) {
+        if (!bigTestBit(exp, i)) {
+            montSqr(ctx, acc, acc);
+            i--;
+            continue;
+        }
+        // The window runs from bit i down to the lowest set bit within w
+        int j = (i - w + 1 > 0) ? i - w + 1 : 0;
+        while (!bigTestBit(exp, j)) j++;
+        int value = 0;
+        for (int b = i; b >= j; b--) value = (value << 1) | bigTestBit(exp, b);
+        if (started) {
+            for (int b = i; b >= j; b--) montSqr(ctx, acc, acc);
+            montMul(ctx, acc, table[value >> 1], acc);
+        } else {
+            for (int l = 0; l < k; l++) acc[l] = table[value >> 1][l];
+            started = true;
+        }
+        i = j - 1;
+    }
+    for (int l = 0; l < k; l++) out[l] = acc[l];
+}
+
+// montPower() for secret exponents. A fixed MONT_CT_WINDOW-bit window walks
+// every limb of exp, doing w squarings and one multiply per window whatever
+// the digit, and the table entry is read by scanning all of them under a
+// mask, so neither the operation sequence nor the memory access pattern
+// depends on exp beyond its limb count. out may alias base.
+static inline void montPowerConstTime(const MontContext& ctx, const uint32_t* base, const BigInt& exp, uint32_t* out) {
+    const int w = MONT_CT_WINDOW;
+    int k = ctx.k;
+    uint32_t table[1 << MONT_CT_WINDOW][MONT_LIMBS];
+    for (int i = 0; i < k; i++) {
+        table[0][i] = ctx.one[i];
+        table[1][i] = base[i];
+    }
+    for (int j = 2; j < (1 << w); j++) {
+        if (j % 2 == 0) montSqr(ctx, table[j / 2], table[j]);
+        else montMul(ctx, table[j - 1], table[1], table[j]);
+    }
+
+    uint32_t acc[MONT_LIMBS];
+    uint32_t entry[MONT_LIMBS];
+    for (int i = 0; i < k; i++) acc[i] = ctx.one[i];
+    int windows = (32 * exp.size + w - 1) / w;
+    for (int win = windows - 1; win >= 0; win--) {
+        for (int b = 0; b < w; b++) montSqr(ctx, acc, acc);
+        uint32_t digit = 0;
+        for (int b = w - 1; b >= 0; b--) {
+            digit = (digit << 1) | (uint32_t)bigTestBit(exp, win * w + b);
+        }
+        for (int i = 0; i < k; i++) entry[i] = 0;
+        for (uint32_t j = 0; j < (1u << w); j++) {
+            // All ones when j == digit, computed without a branch
+            uint32_t mask = ((j ^ digit) - 1) >> 31;
+            mask = 0 - mask;
+            for (int i = 0; i < k; i++) entry[i] |= table[j][i] & mask;
+        }
+        montMul(ctx, acc, entry, acc);
+    }
+    for (int i = 0; i < k; i++) out[i] = acc[i];
+}
+
+// out = base^exp mod m. Odd moduli go through Montgomery form; even ones
+// (never used by RSA or safe-prime DH) fall back to division after every
+// product. Set constTime for a secret exponent with an odd modulus. out
+// must not alias exp. Returns false for a zero or oversized modulus.
+static bool bigPowMod(const BigInt& base, const BigInt& exp, const BigInt& m, BigInt& out, bool constTime = false) {
+    if (m.size == 0 || bigBitLength(m) > BIGINT_MAX_BITS) return false;
+    if (bigBitLength(m) == 1) {
+        out.size = 0;
+        return true;
+    }
+    if (bigIsOdd(m)) {
+        MontContext ctx;
+        uint32_t x[MONT_LIMBS];
+        montSetup(ctx, m);
+        montToDomain(ctx, base, x);
+        if (constTime) montPowerConstTime(ctx, x, exp, x);
+        else montPower(ctx, x, exp, x);
+        montFromDomain(ctx, x, out);
+        return true;
+    }
+
+    BigInt b;
+    BigInt t;
+    bigMod(base, m, b);
+    bigSetU64(out, 1);
+    for (int bit = bigBitLength(exp) - 1; bit >= 0; bit--) {
+        bigMul(out, out, t);
+        bigMod(t, m, out);
+        if (bigTestBit(exp, bit)) {
+            bigMul(out, b, t);
+            bigMod(t, m, out);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,214 @@
+// crypto_src/Common/block_modes.h
+// Block cipher modes of operation (ECB, CBC, CFB, OFB, CTR) written once
+// for any block cipher. A cipher type plugs in by providing:
+//
+//   static constexpr int blockSize;   // bytes, at most MODE_MAX_BLOCK
+//   void encryptBlocks(const uint8_t* in, uint8_t* out, int nblocks) const;
+//   void decryptBlocks(const uint8_t* in, uint8_t* out, int nblocks) const;
+//
+// in and out may be the same buffer. Only ECB and CBC decryption call
+// decryptBlocks(). Directions without a chain dependency (ECB, CBC and CFB
+// decryption, CTR) hand the kernel MODE_BATCH_BLOCKS blocks per call.
+#pragma once
+
+#include <cstdint>
+
+// Blocks per kernel call in the block-parallel directions
+#define MODE_BATCH_BLOCKS 128
+// Largest supported block size in bytes
+#define MODE_MAX_BLOCK 16
+
+// Mode numbers shared by the process_*_mode exports
+enum BlockMode {
+    MODE_ECB = 0,
+    MODE_CBC = 1,
+    MODE_CFB = 2,
+    MODE_OFB = 3,
+    MODE_CTR = 4
+};
+
+template <int N>
+static inline void xorBlock(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    for (int j = 0; j < N; j++) {
+        out[j] = a[j] ^ b[j];
+    }
+}
+
+// Increment a big-endian counter block
+template <int N>
+static inline void incrementBlock(uint8_t* counter) {
+    for (int j = N - 1; j >= 0; j--) {
+        if (++counter[j] != 0) break;
+    }
+}
+
+template <class Cipher>
+void ecbEncrypt(const Cipher& c, const uint8_t* in, uint8_t* out, int len) {
+    c.encryptBlocks(in, out, len / Cipher::blockSize);
+}
+
+template <class Cipher>
+void ecbDecrypt(const Cipher& c, const uint8_t* in, uint8_t* out, int len) {
+    c.decryptBlocks(in, out, len / Cipher::blockSize);
+}
+
+// C[i] = E(P[i] ^ C[i-1]); the chain runs through the output buffer
+template <class Cipher>
+void cbcEncrypt(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    const uint8_t* prev = iv;
+    for (int i = 0; i < len; i += B) {
+        xorBlock<B>(in + i, prev, out + i);
+        c.encryptBlocks(out + i, out + i, 1);
+        prev = out + i;
+    }
+    if (len > 0) {
+        for (int j = 0; j < B; j++) iv[j] = prev[j];
+    }
+}
+
+// P[i] = D(C[i]) ^ C[i-1], decrypted a batch at a time. Blocks are
+// un-chained from the back of the batch so in-place calls still see the
+// ciphertext they need.
+template <class Cipher>
+void cbcDecrypt(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    uint8_t plain[B * MODE_BATCH_BLOCKS];
+    uint8_t nextIv[B];
+    for (int i = 0; i < len; i += B * MODE_BATCH_BLOCKS) {
+        int n = (len - i) / B;
+        if (n > MODE_BATCH_BLOCKS) n = MODE_BATCH_BLOCKS;
+        const uint8_t* src = in + i;
+        uint8_t* dst = out + i;
+        c.decryptBlocks(src, plain, n);
+        for (int j = 0; j < B; j++) nextIv[j] = src[B * (n - 1) + j];
+        for (int k = n - 1; k > 0; k--) {
+            xorBlock<B>(plain + B * k, src + B * (k - 1), dst + B * k);
+        }
+        xorBlock<B>(plain, iv, dst);
+        for (int j = 0; j < B; j++) iv[j] = nextIv[j];
+    }
+}
+
+// Full-block CFB: C[i] = P[i] ^ E(C[i-1]). A trailing partial block uses
+// the leading bytes of its keystream block and ends the message: in both
+// directions iv is left at the last full ciphertext block.
+template <class Cipher>
+void cfbEncrypt(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    int full = len - len % B;
+    for (int i = 0; i < full; i += B) {
+        c.encryptBlocks(iv, iv, 1);
+        for (int j = 0; j < B; j++) {
+            out[i + j] = in[i + j] ^ iv[j];
+            iv[j] = out[i + j];
+        }
+    }
+    if (full < len) {
+        uint8_t keystream[B];
+        c.encryptBlocks(iv, keystream, 1);
+        for (int j = 0; j < len - full; j++) {
+            out[full + j] = in[full + j] ^ keystream[j];
+        }
+    }
+}
+
+// P[i] = C[i] ^ E(C[i-1]); every keystream input is known up front, so the
+// kernel runs a batch at a time
+template <class Cipher>
+void cfbDecrypt(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    uint8_t keystream[B * MODE_BATCH_BLOCKS];
+    for (int i = 0; i < len; i += B * MODE_BATCH_BLOCKS) {
+        int bytes = len - i;
+        if (bytes > B * MODE_BATCH_BLOCKS) bytes = B * MODE_BATCH_BLOCKS;
+        int n = (bytes + B - 1) / B;
+        for (int j = 0; j < B; j++) keystream[j] = iv[j];
+        for (int j = B; j < B * n; j++) keystream[j] = in[i + j - B];
+        // The last full ciphertext block feeds the next batch
+        int full = bytes / B;
+        if (full > 0) {
+            for (int j = 0; j < B; j++) iv[j] = in[i + B * (full - 1) + j];
+        }
+        c.encryptBlocks(keystream, keystream, n);
+        for (int j = 0; j < bytes; j++) {
+            out[i + j] = in[i + j] ^ keystream[j];
+        }
+    }
+}
+
+// OFB: the keystream is E applied repeatedly to the IV, so it is inherently
+// serial; the feedback block stays in iv
+template <class Cipher>
+void ofbProcess(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    for (int i = 0; i < len; i += B) {
+        int n = (len - i < B) ? len - i : B;
+        c.encryptBlocks(iv, iv, 1);
+        for (int j = 0; j < n; j++) {
+            out[i + j] = in[i + j] ^ iv[j];
+        }
+    }
+}
+
+// CTR over the whole block as a big-endian counter. iv is advanced past the
+// blocks used, so consecutive calls continue the stream on block boundaries.
+template <class Cipher>
+void ctrProcess(const Cipher& c, uint8_t* iv, const uint8_t* in, uint8_t* out, int len) {
+    constexpr int B = Cipher::blockSize;
+    uint8_t keystream[B * MODE_BATCH_BLOCKS];
+    for (int i = 0; i < len; i += B * MODE_BATCH_BLOCKS) {
+        int bytes = len - i;
+        if (bytes > B * MODE_BATCH_BLOCKS) bytes = B * MODE_BATCH_BLOCKS;
+        int n = (bytes + B - 1) / B;
+        for (int k = 0; k < n; k++) {
+            for (int j = 0; j < B; j++) keystream[B * k + j] = iv[j];
+            incrementBlock<B>(iv);
+        }
+        c.encryptBlocks(keystream, keystream, n);
+        for (int j = 0; j < bytes; j++) {
+            out[i + j] = in[i + j] ^ keystream[j];
+        }
+    }
+}
+
+// Whether mode needs the cipher's decryption direction
+static inline bool modeUsesDecrypt(int mode, bool encrypt) {
+    return !encrypt && (mode == MODE_ECB || mode == MODE_CBC);
+}
+
+// Run one of the modes above. ECB and CBC need a whole number of blocks;
+// the stream modes (CFB, OFB, CTR) take any length. iv (unused by ECB) is
+// updated so a following call continues the same message; calls that are
+// to be continued should end on a block boundary.
+// Returns false for an unknown mode or a bad length.
+template <class Cipher>
+bool processMode(const Cipher& c, int mode, uint8_t* iv, const uint8_t* in, uint8_t* out, int len, bool encrypt) {
+    static_assert(Cipher::blockSize <= MODE_MAX_BLOCK, "block size too large");
+    constexpr int B = Cipher::blockSize;
+    if (len < 0) return false;
+    switch (mode) {
+        case MODE_ECB:
+            if (len % B != 0) return false;
+            if (encrypt) ecbEncrypt(c, in, out, len);
+            else ecbDecrypt(c, in, out, len);
+            return true;
+        case MODE_CBC:
+            if (len % B != 0) return false;
+            if (encrypt) cbcEncrypt(c, iv, in, out, len);
+            else cbcDecrypt(c, iv, in, out, len);
+            return true;
+        case MODE_CFB:
+            if (encrypt) cfbEncrypt(c, iv, in, out, len);
+            else cfbDecrypt(c, iv, in, out, len);
+            return true;
+        case MODE_OFB:
+            ofbProcess(c, iv, in, out, len);
+            return true;
+        case MODE_CTR:
+            ctrProcess(c, iv, in, out, len);
+            return true;
+        default:
+            return false;
+    }
+}
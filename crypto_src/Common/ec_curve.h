@@ -0,0 +1,280 @@
+// crypto_src/Common/ec_curve.h
+// Arithmetic on the demo curve y^2 = x^3 + b over GF(P), shared by the ECC
+// (ECDH) and ECIES modules. Sums are formed in Jacobian coordinates
+// (X : Y : Z), standing for the affine point (X / Z^2, Y / Z^3), which need
+// no field inversion; scalarMult() inverts once at the end to return an
+// affine point.
+#pragma once
+
+typedef long long int ll;
+
+// The field prime and curve coefficients. a = 0 is built into the doubling
+// formula. The modules once documented b = 7, but the chord-and-tangent
+// formulas never read b, and the generator (2, 5) lies on b = 17, so b = 17
+// is the curve every key so far was computed on.
+const ll P = 3851;
+const ll A = 0;
+const ll B = 17;
+
+// An affine point, or the point at infinity (the group identity)
+struct Point {
+    ll x, y;
+    bool infinity;
+};
+
+// Z = 0 is the point at infinity
+struct JacobianPoint {
+    ll X, Y, Z;
+};
+
+// The generator shared by key generation and ECIES, and its order
+static const Point G = {2, 5, false};
+const ll G_ORDER = 3852;
+
+static inline ll fieldReduce(ll a) {
+    a %= P;
+    return (a < 0) ? a + P : a;
+}
+
+static inline ll fieldAdd(ll a, ll b) {
+    ll s = a + b;
+    return (s >= P) ? s - P : s;
+}
+
+static inline ll fieldSub(ll a, ll b) {
+    ll d = a - b;
+    return (d < 0) ? d + P : d;
+}
+
+// Operands are below P < 2^31, so the product fits in 63 bits
+static inline ll fieldMul(ll a, ll b) {
+    return a * b % P;
+}
+
+// a^-1 mod P by the extended Euclidean algorithm, for a != 0 (mod P)
+static inline ll fieldInverse(ll a) {
+    ll r0 = P, r1 = fieldReduce(a);
+    ll t0 = 0, t1 = 1;
+    while (r1 != 0) {
+        ll q = r0 / r1;
+        ll r = r0 - q * r1;
+        r0 = r1;
+        r1 = r;
+        ll t = t0 - q * t1;
+        t0 = t1;
+        t1 = t;
+    }
+    return fieldReduce(t0);
+}
+
+// Whether p is the point at infinity or satisfies the curve equation
+static inline bool onCurve(const Point& p) {
+    if (p.infinity) return true;
+    if (p.x < 0 || p.x >= P || p.y < 0 || p.y >= P) return false;
+    ll rhs = fieldAdd(fieldMul(fieldMul(p.x, p.x), p.x), fieldAdd(fieldMul(A, p.x), B));
+    return fieldMul(p.y, p.y) == rhs;
+}
+
+static inline JacobianPoint toJacobian(const Point& p) {
+    if (p.infinity) return {1, 1, 0};
+    return {p.x, p.y, 1};
+}
+
+// The affine form of p: one inversion of Z
+static inline Point toAffine(const JacobianPoint& p) {
+    if (p.Z == 0) return {0, 0, true};
+    ll zInv = fieldInverse(p.Z);
+    ll zInv2 = fieldMul(zInv, zInv);
+    return {fieldMul(p.X, zInv2), fieldMul(p.Y, fieldMul(zInv2, zInv)), false};
+}
+
+// 2p for a = 0 (dbl-2009-l). A point with Y = 0 has order 2 and doubles to
+// Z = 0, infinity, with no special case.
+static inline JacobianPoint jacobianDouble(const JacobianPoint& p) {
+    if (p.Z == 0) return p;
+    ll a = fieldMul(p.X, p.X);
+    ll b = fieldMul(p.Y, p.Y);
+    ll c = fieldMul(b, b);
+    ll t = fieldAdd(p.X, b);
+    ll d = fieldSub(fieldSub(fieldMul(t, t), a), c);
+    d = fieldAdd(d, d);
+    ll e = fieldAdd(fieldAdd(a, a), a);
+    ll f = fieldMul(e, e);
+    JacobianPoint r;
+    r.X = fieldSub(f, fieldAdd(d, d));
+    ll c8 = fieldAdd(c, c);
+    c8 = fieldAdd(c8, c8);
+    c8 = fieldAdd(c8, c8);
+    r.Y = fieldSub(fieldMul(e, fieldSub(d, r.X)), c8);
+    r.Z = fieldMul(fieldAdd(p.Y, p.Y), p.Z);
+    return r;
+}
+
+// p + q (add-2007-bl). Equal inputs fall through to doubling and opposite
+// ones give infinity.
+static inline JacobianPoint jacobianAdd(const JacobianPoint& p, const JacobianPoint& q) {
+    if (p.Z == 0) return q;
+    if (q.Z == 0) return p;
+    ll z1z1 = fieldMul(p.Z, p.Z);
+    ll z2z2 = fieldMul(q.Z, q.Z);
+    ll u1 = fieldMul(p.X, z2z2);
+    ll u2 = fieldMul(q.X, z1z1);
+    ll s1 = fieldMul(fieldMul(p.Y, q.Z), z2z2);
+    ll s2 = fieldMul(fieldMul(q.Y, p.Z), z1z1);
+    ll h = fieldSub(u2, u1);
+    ll r = fieldSub(s2, s1);
+    if (h == 0) {
+        if (r == 0) return jacobianDouble(p);
+        return {1, 1, 0};
+    }
+    ll h2 = fieldAdd(h, h);
+    ll i = fieldMul(h2, h2);
+    ll j = fieldMul(h, i);
+    r = fieldAdd(r, r);
+    ll v = fieldMul(u1, i);
+    JacobianPoint out;
+    out.X = fieldSub(fieldSub(fieldMul(r, r), j), fieldAdd(v, v));
+    ll s1j = fieldMul(s1, j);
+    out.Y = fieldSub(fieldMul(r, fieldSub(v, out.X)), fieldAdd(s1j, s1j));
+    ll zs = fieldAdd(p.Z, q.Z);
+    out.Z = fieldMul(fieldSub(fieldSub(fieldMul(zs, zs), z1z1), z2z2), h);
+    return out;
+}
+
+// p + q for an affine q (madd-2007-bl), saving the work Z2 = 1 makes
+// redundant
+static inline JacobianPoint jacobianAddAffine(const JacobianPoint& p, const Point& q) {
+    if (q.infinity) return p;
+    if (p.Z == 0) return toJacobian(q);
+    ll z1z1 = fieldMul(p.Z, p.Z);
+    ll u2 = fieldMul(q.x, z1z1);
+    ll s2 = fieldMul(fieldMul(q.y, p.Z), z1z1);
+    ll h = fieldSub(u2, p.X);
+    ll r = fieldSub(s2, p.Y);
+    if (h == 0) {
+        if (r == 0) return jacobianDouble(p);
+        return {1, 1, 0};
+    }
+    ll hh = fieldMul(h, h);
+    ll i = fieldAdd(hh, hh);
+    i = fieldAdd(i, i);
+    ll j = fieldMul(h, i);
+    r = fieldAdd(r, r);
+    ll v = fieldMul(p.X, i);
+    JacobianPoint out;
+    out.X = fieldSub(fieldSub(fieldMul(r, r), j), fieldAdd(v, v));
+    ll yj = fieldMul(p.Y, j);
+    out.Y = fieldSub(fieldMul(r, fieldSub(v, out.X)), fieldAdd(yj, yj));
+    ll zh = fieldAdd(p.Z, h);
+    out.Z = fieldSub(fieldSub(fieldMul(zh, zh), z1z1), hh);
+    return out;
+}
+
+// Width of the NAF recoding in scalarMult(); it keeps the odd multiples
+// p, 3p, ..., (2^(w-1) - 1)p. Scalars here are reduced below 2^12, too
+// short to repay building any table, so plain NAF (w = 2) is fastest.
+#ifndef WNAF_WIDTH
+#define WNAF_WIDTH 2
+#endif
+#define WNAF_TABLE_SIZE (1 << (WNAF_WIDTH - 2))
+
+// Width-w NAF digits of m >= 0, least significant first: each nonzero digit
+// is odd and below 2^(w-1) in magnitude, and any w consecutive digits hold
+// at most one nonzero. Returns the digit count.
+static inline int wnafRecode(unsigned long long m, signed char* digits) {
+    int len = 0;
+    while (m != 0) {
+        int d = 0;
+        if (m & 1) {
+            d = (int)(m & ((1 << WNAF_WIDTH) - 1));
+            if (d >= (1 << (WNAF_WIDTH - 1))) d -= (1 << WNAF_WIDTH);
+            m -= (unsigned long long)(long long)d;
+        }
+        digits[len++] = (signed char)d;
+        m >>= 1;
+    }
+    return len;
+}
+
+// k * p for a point p on the curve, by width-w NAF. Every curve point's order
+// divides the group order G_ORDER (G generates the group), so k is first
+// reduced mod G_ORDER; negative digits add the negated table entry.
+static inline Point scalarMult(ll k, const Point& p) {
+    ll m = k % G_ORDER;
+    if (m < 0) m += G_ORDER;
+    if (m == 0 || p.infinity) return {0, 0, true};
+
+    Point base = {fieldReduce(p.x), fieldReduce(p.y), false};
+#if WNAF_WIDTH > 2
+    // 3p, 5p, ... from 2p (odd[0] is p, used as base). They stay Jacobian:
+    // on this field an inversion to make them affine costs more than mixed
+    // additions save.
+    JacobianPoint odd[WNAF_TABLE_SIZE];
+    odd[0] = toJacobian(base);
+    JacobianPoint twice = jacobianDouble(odd[0]);
+    for (int i = 1; i < WNAF_TABLE_SIZE; i++) odd[i] = jacobianAdd(odd[i - 1], twice);
+#endif
+
+    signed char digits[64];
+    int len = wnafRecode((unsigned long long)m, digits);
+    JacobianPoint acc = {1, 1, 0};
+    for (int i = len - 1; i >= 0; i--) {
+        acc = jacobianDouble(acc);
+        int d = digits[i];
+        if (d == 0) continue;
+#if WNAF_WIDTH > 2
+        int idx = ((d < 0) ? -d : d) >> 1;
+        if (idx != 0) {
+            JacobianPoint q = odd[idx];
+            if (d < 0) q.Y = fieldSub(0, q.Y);
+            acc = jacobianAdd(acc, q);
+            continue;
+        }
+#endif
+        // +-p itself is affine, so take the cheaper mixed addition
+        Point q = base;
+        if (d < 0) q.y = fieldSub(0, q.y);
+        acc = jacobianAddAffine(acc, q);
+    }
+    return toAffine(acc);
+}
+
+// Fixed-base table for G: entry[w][d] = d * 16^w * G. Three 4-bit windows
+// cover every scalar below G_ORDER < 16^3.
+#define GEN_WINDOW_BITS 4
+#define GEN_WINDOWS 3
+
+struct GeneratorTable {
+    Point entry[GEN_WINDOWS][1 << GEN_WINDOW_BITS];
+};
+
+// Built on first use, one inversion per entry
+static inline const GeneratorTable& generatorTable() {
+    static const GeneratorTable table = [] {
+        GeneratorTable t;
+        JacobianPoint base = toJacobian(G);
+        for (int w = 0; w < GEN_WINDOWS; w++) {
+            JacobianPoint acc = {1, 1, 0};
+            for (int d = 0; d < (1 << GEN_WINDOW_BITS); d++) {
+                t.entry[w][d] = toAffine(acc);
+                acc = jacobianAdd(acc, base);
+            }
+            base = acc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// k * G from the fixed-base table: GEN_WINDOWS mixed additions, no doublings
+static inline Point generatorMult(ll k) {
+    ll m = k % G_ORDER;
+    if (m < 0) m += G_ORDER;
+    const GeneratorTable& table = generatorTable();
+    JacobianPoint acc = {1, 1, 0};
+    for (int w = 0; w < GEN_WINDOWS; w++) {
+        int d = (int)(m >> (GEN_WINDOW_BITS * w)) & ((1 << GEN_WINDOW_BITS) - 1);
+        acc = jacobianAddAffine(acc, table.entry[w][d]);
+    }
+    return toAffine(acc);
+}
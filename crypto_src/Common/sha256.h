@@ -0,0 +1,131 @@
+// crypto_src/Common/sha256.h
+// SHA-256 (FIPS 180-4) and the MGF1 mask generation function built on it
+// (PKCS#1 v2.2), for OAEP padding.
+#pragma once
+
+#include <cstdint>
+
+#define SHA256_DIGEST_SIZE 32
+
+static constexpr uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+struct Sha256 {
+    uint32_t state[8];
+    uint8_t buffer[64];
+    uint64_t length; // bytes hashed so far
+};
+
+static inline uint32_t sha256Rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// One 64-byte block into the state
+static inline void sha256Block(uint32_t* state, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+               ((uint32_t)block[4 * i + 2] << 8) | block[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = sha256Rotr(w[i - 15], 7) ^ sha256Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = sha256Rotr(w[i - 2], 17) ^ sha256Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (sha256Rotr(e, 6) ^ sha256Rotr(e, 11) ^ sha256Rotr(e, 25)) +
+                      ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+        uint32_t t2 = (sha256Rotr(a, 2) ^ sha256Rotr(a, 13) ^ sha256Rotr(a, 22)) +
+                      ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+static inline void sha256Init(Sha256& ctx) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    for (int i = 0; i < 8; i++) ctx.state[i] = iv[i];
+    ctx.length = 0;
+}
+
+static inline void sha256Update(Sha256& ctx, const uint8_t* data, int len) {
+    int used = (int)(ctx.length % 64);
+    ctx.length += len;
+    if (used) {
+        int take = (len < 64 - used) ? len : 64 - used;
+        for (int i = 0; i < take; i++) ctx.buffer[used + i] = data[i];
+        data += take;
+        len -= take;
+        if (used + take < 64) return;
+        sha256Block(ctx.state, ctx.buffer);
+    }
+    for (; len >= 64; data += 64, len -= 64) {
+        sha256Block(ctx.state, data);
+    }
+    for (int i = 0; i < len; i++) ctx.buffer[i] = data[i];
+}
+
+static inline void sha256Final(Sha256& ctx, uint8_t* digest) {
+    uint64_t bits = ctx.length * 8;
+    uint8_t pad[72] = {0x80};
+    int padLen = (int)((ctx.length % 64 < 56) ? 56 - ctx.length % 64 : 120 - ctx.length % 64);
+    for (int i = 0; i < 8; i++) pad[padLen + i] = (uint8_t)(bits >> (56 - 8 * i));
+    sha256Update(ctx, pad, padLen + 8);
+    for (int i = 0; i < 8; i++) {
+        digest[4 * i] = (uint8_t)(ctx.state[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(ctx.state[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(ctx.state[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)ctx.state[i];
+    }
+}
+
+// One-shot SHA-256 of len bytes
+static inline void sha256(const uint8_t* data, int len, uint8_t* digest) {
+    Sha256 ctx;
+    sha256Init(ctx);
+    sha256Update(ctx, data, len);
+    sha256Final(ctx, digest);
+}
+
+// XOR MGF1-SHA-256(seed) into out[0..len)
+static inline void mgf1XorSha256(const uint8_t* seed, int seedLen, uint8_t* out, int len) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    for (uint32_t counter = 0; len > 0; counter++) {
+        uint8_t c[4] = {(uint8_t)(counter >> 24), (uint8_t)(counter >> 16), (uint8_t)(counter >> 8), (uint8_t)counter};
+        Sha256 ctx;
+        sha256Init(ctx);
+        sha256Update(ctx, seed, seedLen);
+        sha256Update(ctx, c, 4);
+        sha256Final(ctx, digest);
+        int n = (len < SHA256_DIGEST_SIZE) ? len : SHA256_DIGEST_SIZE;
+        for (int i = 0; i < n; i++) out[i] ^= digest[i];
+        out += n;
+        len -= n;
+    }
+}
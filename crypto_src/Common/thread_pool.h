@@ -0,0 +1,152 @@
+// crypto_src/Common/thread_pool.h
+// Fixed-size worker pool shared by the crypto modules. Native builds and the
+// pthreads WASM builds (-pthread) get real workers; plain WASM builds run
+// every task on the calling thread.
+#pragma once
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define CRYPTO_THREADS 1
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+// Upper bound on threads working on one job, the caller included. The
+// pthreads WASM builds preallocate this many workers (-sPTHREAD_POOL_SIZE in
+// built_wasm.sh), so the pool never has to spawn a thread from the browser
+// main thread.
+#ifndef CRYPTO_MAX_THREADS
+#ifdef __EMSCRIPTEN__
+#define CRYPTO_MAX_THREADS 4
+#else
+#define CRYPTO_MAX_THREADS 16
+#endif
+#endif
+
+#ifdef CRYPTO_THREADS
+
+class ThreadPool {
+public:
+    // The process-wide pool, started on first use
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Threads that work on a job: the workers plus the calling thread
+    int size() const {
+        return (int)workers.size() + 1;
+    }
+
+    // Runs task(i) for every i in [0, count) and returns when all are done.
+    // The caller takes tasks too. Calls made from inside a task run serially.
+    template <typename Task>
+    void parallelFor(int count, Task&& task) {
+        if (count <= 0) return;
+        if (count == 1 || workers.empty() || insideTask) {
+            for (int i = 0; i < count; i++) task(i);
+            return;
+        }
+
+        std::function<void(int)> fn(task);
+        std::lock_guard<std::mutex> submit(submitMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            nextIndex.store(0);
+            pending = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        runJob();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+private:
+    ThreadPool() {
+        int n = (int)std::thread::hardware_concurrency();
+        if (n > CRYPTO_MAX_THREADS) n = CRYPTO_MAX_THREADS;
+        for (int i = 1; i < n; i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    void runJob() {
+        insideTask = true;
+        for (int i = nextIndex.fetch_add(1); i < jobCount; i = nextIndex.fetch_add(1)) {
+            (*job)(i);
+        }
+        insideTask = false;
+    }
+
+    void workerLoop() {
+        unsigned seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runJob();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0) done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;                  // one job at a time
+    std::mutex mutex;                        // guards the fields below
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{0};
+    int pending = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+    static inline thread_local bool insideTask = false;
+};
+
+template <typename Task>
+inline void parallelFor(int count, Task&& task) {
+    ThreadPool::instance().parallelFor(count, task);
+}
+
+// Threads a parallelFor() job runs on, the caller included
+inline int parallelThreads() {
+    return ThreadPool::instance().size();
+}
+
+#else
+
+// Single-threaded build: same interface, tasks run in order on the caller
+template <typename Task>
+inline void parallelFor(int count, Task&& task) {
+    for (int i = 0; i < count; i++) task(i);
+}
+
+inline int parallelThreads() {
+    return 1;
+}
+
+#endif // CRYPTO_THREADS
@@ -1,15 +1,28 @@
 // crypto_src/DES/des.cpp
-// Real DES implementation with proper cryptographic security
+// DES (FIPS 46-3): table-driven 64-bit engine, bitsliced 64/128-block kernels
+// and a bitsliced known-plaintext key search
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <new>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
-#include <cstring>
-#include <bitset>
-#include <vector>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
 
-using namespace std;
+#include "../Common/block_modes.h"
+#include "../Common/thread_pool.h"
 
-// DES permutation tables
-const vector<int> parityTable = {
+// Bit positions in the tables below count from 1 at the most significant bit,
+// as in the standard.
+
+// Permuted choice 1: drops the parity bits of the 64-bit key
+static constexpr uint8_t parityTable[56] = {
     57,49,41,33,25,17,9,1,
     58,50,42,34,26,18,10,2,
     59,51,43,35,27,19,11,3,
@@ -19,7 +32,8 @@ const vector<int> parityTable = {
     29,21,13,5,28,20,12,4
 };
 
-const vector<int> CompressionPBox = {
+// Permuted choice 2: selects the 48-bit round key from C || D
+static constexpr uint8_t CompressionPBox[48] = {
     14,17,11,24,1,5,3,28,
     15,6,21,10,23,19,12,4,
     26,8,16,7,27,20,13,2,
@@ -28,7 +42,7 @@ const vector<int> CompressionPBox = {
     34,53,46,42,50,36,29,32
 };
 
-const vector<int> InitialPermutation = {
+static constexpr uint8_t InitialPermutation[64] = {
     58, 50, 42, 34, 26, 18, 10, 2,
     60, 52, 44, 36, 28, 20, 12, 4,
     62, 54, 46, 38, 30, 22, 14, 6,
@@ -39,7 +53,7 @@ const vector<int> InitialPermutation = {
     63, 55, 47, 39, 31, 23, 15, 7
 };
 
-const vector<int> FinalPermutation = {
+static constexpr uint8_t FinalPermutation[64] = {
     40, 8, 48, 16, 56, 24, 64, 32,
     39, 7, 47, 15, 55, 23, 63, 31,
     38, 6, 46, 14, 54, 22, 62, 30,
@@ -50,352 +64,1334 @@ const vector<int> FinalPermutation = {
     33, 1, 41, 9, 49, 17, 57, 25
 };
 
-const vector<int> StraightPBox = {
+static constexpr uint8_t StraightPBox[32] = {
     16, 7, 20, 21, 29, 12, 28, 17,
     1, 15, 23, 26, 5, 18, 31, 10,
     2, 8, 24, 14, 32, 27, 3, 9,
     19, 13, 30, 6, 22, 11, 4, 25
 };
 
-const vector<int> ExpansionPBox = {
-    32, 1, 2, 3, 4, 5,
-    4, 5, 6, 7, 8, 9,
-    8, 9, 10, 11, 12, 13,
-    12, 13, 14, 15, 16, 17,
-    16, 17, 18, 19, 20, 21,
-    20, 21, 22, 23, 24, 25,
-    24, 25, 26, 27, 28, 29,
-    28, 29, 30, 31, 32, 1
-};
+// Left rotations of C and D before each round
+static constexpr uint8_t keyShifts[16] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
 
-// S-Boxes (cryptographically correct)
-const int S_BOXES[8][4][16] = {
-    // S-box 1
+// S-boxes S1..S8, indexed [box][row][column]
+static constexpr uint8_t S_BOXES[8][4][16] = {
     {
         {14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7},
         {0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
-        {4, 1, 14, 8, 13, 6, 11, 3, 15, 12, 9, 7, 5, 0, 6, 10},
-        {1, 15, 6, 8, 13, 11, 3, 4, 7, 9, 5, 12, 0, 14, 10, 2}
+        {4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0},
+        {15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13}
     },
-    // S-box 2
     {
         {15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10},
         {3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5},
-        {0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 15, 2},
-        {12, 7, 6, 5, 10, 15, 13, 8, 9, 1, 3, 14, 0, 11, 4, 2}
+        {0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15},
+        {13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9}
     },
-    // S-box 3
     {
-        {10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 8, 2, 4},
-        {7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15},
-        {13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 9, 1, 14, 10},
-        {1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2}
+        {10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8},
+        {13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1},
+        {13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7},
+        {1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12}
     },
-    // S-box 4
     {
         {7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15},
-        {13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 9, 1, 14, 10},
-        {1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2},
-        {14, 7, 11, 6, 0, 9, 10, 1, 5, 3, 12, 8, 2, 13, 15, 4}
+        {13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9},
+        {10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4},
+        {3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14}
     },
-    // S-box 5
     {
         {2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9},
         {14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6},
-        {1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2},
-        {7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15}
+        {4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14},
+        {11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3}
     },
-    // S-box 6
     {
-        {12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 14, 5, 11, 7, 4},
-        {2, 7, 12, 1, 10, 6, 15, 13, 8, 9, 11, 5, 3, 14, 4, 0},
-        {4, 11, 2, 14, 15, 0, 8, 13, 9, 5, 7, 12, 3, 10, 1, 6},
-        {11, 8, 12, 2, 4, 7, 1, 14, 10, 15, 6, 0, 9, 3, 5, 13}
+        {12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11},
+        {10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8},
+        {9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6},
+        {4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13}
     },
-    // S-box 7
     {
-        {4, 11, 2, 14, 15, 0, 8, 13, 9, 5, 7, 12, 3, 10, 1, 6},
-        {11, 8, 12, 2, 4, 7, 1, 14, 10, 15, 6, 0, 9, 3, 5, 13},
-        {0, 9, 4, 7, 6, 10, 11, 15, 8, 12, 2, 5, 13, 14, 1, 3},
-        {1, 8, 12, 5, 9, 0, 15, 2, 14, 7, 13, 10, 3, 4, 6, 11}
+        {4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1},
+        {13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6},
+        {1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2},
+        {6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12}
     },
-    // S-box 8
     {
         {13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7},
         {1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2},
-        {7, 14, 9, 10, 1, 3, 11, 5, 12, 6, 8, 13, 15, 0, 2, 4},
-        {10, 5, 9, 12, 3, 7, 8, 1, 2, 6, 11, 0, 13, 14, 15, 4}
+        {7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8},
+        {2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11}
     }
 };
 
-// Helper functions
-bitset<64> initialbox(bitset<64> text) {
-    vector<int> temp(64);
-    for (int i = 63; i >= 0; i--) {
-        temp[63-i] = text[i];
+// Gather bits of an inBits-wide value into an n-bit result, using 1-based
+// positions counted from the most significant bit
+constexpr uint64_t permute(uint64_t in, const uint8_t* table, int n, int inBits) {
+    uint64_t out = 0;
+    for (int i = 0; i < n; i++) {
+        out = (out << 1) | ((in >> (inBits - table[i])) & 1);
     }
-    string ans = "";
-    for (int i = 0; i < 64; i++) {
-        ans += to_string(temp[InitialPermutation[i]-1]);
+    return out;
+}
+
+// SP[i][x]: S-box i+1 applied to the 6-bit input x (bits b1..b6, row b1b6,
+// column b2..b5), placed at its output nibble and run through P. One round
+// function is then eight lookups and ORs.
+//
+// IP/FP[k][v]: the permutation of a block whose only non-zero byte is byte
+// k (0 = most significant) with value v. A full permutation is the OR of
+// eight lookups.
+struct DesTables {
+    uint32_t SP[8][64];
+    uint64_t IP[8][256];
+    uint64_t FP[8][256];
+};
+
+constexpr DesTables makeDesTables() {
+    DesTables t = {};
+    for (int box = 0; box < 8; box++) {
+        for (int x = 0; x < 64; x++) {
+            int row = ((x >> 4) & 2) | (x & 1);
+            int col = (x >> 1) & 15;
+            uint64_t s = (uint64_t)S_BOXES[box][row][col] << (28 - 4 * box);
+            t.SP[box][x] = (uint32_t)permute(s, StraightPBox, 32, 32);
+        }
     }
-    return bitset<64>(ans);
+    for (int k = 0; k < 8; k++) {
+        for (int v = 0; v < 256; v++) {
+            uint64_t block = (uint64_t)v << (56 - 8 * k);
+            t.IP[k][v] = permute(block, InitialPermutation, 64, 64);
+            t.FP[k][v] = permute(block, FinalPermutation, 64, 64);
+        }
+    }
+    return t;
 }
 
-bitset<64> finalbox(bitset<64> text) {
-    vector<int> temp(64);
-    for (int i = 63; i >= 0; i--) {
-        temp[63-i] = text[i];
+static constexpr DesTables desTables = makeDesTables();
+
+static inline uint64_t loadBlock(const uint8_t* p) {
+    uint64_t w = 0;
+    for (int i = 0; i < 8; i++) {
+        w = (w << 8) | p[i];
     }
-    string ans = "";
-    for (int i = 0; i < 64; i++) {
-        ans += to_string(temp[FinalPermutation[i]-1]);
+    return w;
+}
+
+static inline void storeBlock(uint8_t* p, uint64_t w) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)w;
+        w >>= 8;
     }
-    return bitset<64>(ans);
 }
 
-bitset<56> parityDrop(const bitset<64>& key) {
-    vector<int> temp(64);
-    for (int i = 63; i >= 0; i--) {
-        temp[63-i] = key[i];
+// Byte-indexed table permutation (IP or FP)
+static inline uint64_t permuteBlock(const uint64_t (&table)[8][256], uint64_t x) {
+    return table[0][x >> 56] | table[1][(x >> 48) & 0xff] |
+           table[2][(x >> 40) & 0xff] | table[3][(x >> 32) & 0xff] |
+           table[4][(x >> 24) & 0xff] | table[5][(x >> 16) & 0xff] |
+           table[6][(x >> 8) & 0xff] | table[7][x & 0xff];
+}
+
+// f(R, K). The expansion E hands S-box i bits 4i..4i+5 of R (1-based, with
+// bit 0 meaning bit 32). In R rotated left by 1 the even-numbered boxes
+// S2, S4, S6, S8 find their six bits at byte offsets 24, 16, 8, 0, and in R
+// rotated right by 3 so do S1, S3, S5, S7. The round key is stored in the
+// same two layouts, so E costs two rotations and the key mix two XORs.
+static inline uint32_t feistel(uint32_t r, const uint32_t* k) {
+    uint32_t x = ((r << 1) | (r >> 31)) ^ k[0];
+    uint32_t y = ((r >> 3) | (r << 29)) ^ k[1];
+    const uint32_t (&SP)[8][64] = desTables.SP;
+    return SP[1][(x >> 24) & 63] | SP[3][(x >> 16) & 63] | SP[5][(x >> 8) & 63] | SP[7][x & 63] |
+           SP[0][(y >> 24) & 63] | SP[2][(y >> 16) & 63] | SP[4][(y >> 8) & 63] | SP[6][y & 63];
+}
+
+// 16 round keys, each as the two words feistel() expects, in the order one
+// DES pass applies them (reversed for decryption)
+using DesSchedule = uint32_t[16][2];
+
+// Expand a key into its encryption schedule
+void desKeySchedule(const uint8_t* key, DesSchedule& roundKeys) {
+    uint64_t cd = permute(loadBlock(key), parityTable, 56, 64);
+    uint32_t c = (uint32_t)(cd >> 28) & 0x0fffffff;
+    uint32_t d = (uint32_t)cd & 0x0fffffff;
+    for (int round = 0; round < 16; round++) {
+        int s = keyShifts[round];
+        c = ((c << s) | (c >> (28 - s))) & 0x0fffffff;
+        d = ((d << s) | (d >> (28 - s))) & 0x0fffffff;
+        uint64_t k = permute(((uint64_t)c << 28) | d, CompressionPBox, 48, 56);
+        roundKeys[round][0] = 0;
+        roundKeys[round][1] = 0;
+        for (int i = 0; i < 8; i++) {
+            uint32_t chunk = (uint32_t)(k >> (42 - 6 * i)) & 63;
+            roundKeys[round][(i & 1) ^ 1] |= chunk << (24 - 8 * (i >> 1));
+        }
     }
-    string ans = "";
-    for (int i = 0; i < 56; i++) {
-        ans += to_string(temp[parityTable[i]-1]);
+}
+
+// The decryption schedule: the same round keys in reverse order
+void desReverseSchedule(const DesSchedule& encKeys, DesSchedule& decKeys) {
+    for (int round = 0; round < 16; round++) {
+        decKeys[round][0] = encKeys[15 - round][0];
+        decKeys[round][1] = encKeys[15 - round][1];
     }
-    return bitset<56>(ans);
 }
 
-bitset<48> CompressionPBoxFun(bitset<56> key) {
-    vector<int> temp(56);
-    for (int i = 55; i >= 0; i--) {
-        temp[55-i] = key[i];
+// Sixteen rounds on (l, r)
+static inline void desRounds(uint32_t& l, uint32_t& r, const DesSchedule& roundKeys) {
+    for (int round = 0; round < 16; round++) {
+        uint32_t t = r;
+        r = l ^ feistel(r, roundKeys[round]);
+        l = t;
     }
-    string ans = "";
-    for (int i = 0; i < 48; i++) {
-        ans += to_string(temp[CompressionPBox[i]-1]);
+}
+
+// One block through Stages DES passes (1 for DES, 3 for EDE). Between passes
+// FP and the next IP cancel, so only the half swap remains.
+template <int Stages>
+static inline void desBlock(const uint8_t* in, uint8_t* out, const DesSchedule* const* stages) {
+    uint64_t x = permuteBlock(desTables.IP, loadBlock(in));
+    uint32_t l = (uint32_t)(x >> 32);
+    uint32_t r = (uint32_t)x;
+    for (int s = 0; s < Stages; s++) {
+        if (s > 0) {
+            uint32_t t = l;
+            l = r;
+            r = t;
+        }
+        desRounds(l, r, *stages[s]);
     }
-    return bitset<48>(ans);
+    storeBlock(out, permuteBlock(desTables.FP, ((uint64_t)r << 32) | l));
+}
+
+// --- Bitsliced DES ---
+//
+// 64 blocks are transposed into 64 bit-planes (plane i holds bit i+1 of every
+// block), so IP, FP and E become plane renumbering and each S-box is a
+// boolean circuit evaluated on all blocks at once. No table lookups depend on
+// the data or key, so this path is constant-time. The word type W is
+// uint64_t (64 blocks) or, with SIMD128, v128_t (128 blocks).
+
+#if defined(__GNUC__)
+#define DES_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define DES_FORCE_INLINE inline
+#endif
+
+// Blocks per pass of the scalar and SIMD bitsliced kernels
+#define DES_BITSLICE_BLOCKS 64
+#define DES_BITSLICE_WIDE_BLOCKS 128
+
+// S-box circuits. Each output bit is written as A ^ p.B ^ q.C ^ pq.D over
+// two "outer" inputs p, q, where A..D are algebraic normal forms (Moebius
+// transforms of the truth table) in the other four inputs; shared
+// subexpressions were then factored out greedily. a1..a6 are the S-box input
+// bits b1..b6 and the outputs are XORed into o1..o4 (o1 = most significant).
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox1(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a4 & a3;
+    W t2 = a5 & a3;
+    W t3 = a5 & a4;
+    W t4 = a6 & a3;
+    W t5 = a6 & a4;
+    W t6 = a6 & a5;
+    W t7 = t3 & a3;
+    W t8 = t5 & a3;
+    W t9 = t6 & a3;
+    W t10 = t6 & a4;
+    W t11 = t10 & a3;
+    W t12 = t1 ^ a5;
+    W t13 = a3 ^ t8;
+    W t14 = t3 ^ a6;
+    W t15 = a4 ^ t5;
+    W t16 = t2 ^ t12;
+    W t17 = t6 ^ t13;
+    W t18 = t4 ^ t14;
+    W t19 = t9 ^ t17;
+    W t20 = a6 ^ t10;
+    W t21 = t11 ^ t14;
+    W t22 = t15 ^ t16;
+    W t23 = t13 ^ t20;
+    W t24 = t3 ^ t19;
+    W t25 = t7 ^ t22;
+    W t26 = t4 ^ t23;
+    W t27 = t10 ^ t18;
+    W t28 = t2 ^ t19;
+    W t29 = t1 ^ t15;
+    W t30 = a1 & a2;
+    W t31 = t7 ^ t12 ^ t23;
+    W t32 = a3 ^ t1;
+    W t33 = t8 ^ t25;
+    W t34 = t24 ^ t29;
+    W t35 = t5 ^ t28 ^ t21;
+    W t36 = t15 ^ t18;
+    W t37 = a3 ^ t9 ^ t12 ^ t21;
+    W t38 = t9 ^ t26 ^ t16;
+    W t39 = t8 ^ a4 ^ t27 ^ t16;
+    W t40 = t22 ^ t26;
+    W t41 = t6 ^ t11 ^ t12;
+    W t42 = t27 ^ t28 ^ t29;
+    W t43 = t6 ^ a4 ^ t2;
+    W t44 = t5 ^ t9 ^ a5 ^ t18;
+    W t45 = t25 ^ t17 ^ t21;
+    W t46 = t12 ^ t24;
+    o1 ^= ~t31 ^ (a2 & ~t32) ^ (a1 & ~t33) ^ (t30 & t34);
+    o2 ^= ~t35 ^ (a2 & ~t36) ^ (a1 & t37) ^ (t30 & ~t38);
+    o3 ^= ~t39 ^ (a2 & t40) ^ (a1 & ~t41) ^ (t30 & ~t42);
+    o4 ^= t43 ^ (a2 & ~t44) ^ (a1 & t45) ^ (t30 & t46);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox2(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a2 & a1;
+    W t2 = a5 & a1;
+    W t3 = a5 & a2;
+    W t4 = a6 & a1;
+    W t5 = a6 & a2;
+    W t6 = a6 & a5;
+    W t7 = t3 & a1;
+    W t8 = t5 & a1;
+    W t9 = t6 & a1;
+    W t10 = t6 & a2;
+    W t11 = t10 & a1;
+    W t12 = a1 ^ a5;
+    W t13 = t8 ^ t9;
+    W t14 = t5 ^ t11;
+    W t15 = a6 ^ t12;
+    W t16 = a2 ^ t7;
+    W t17 = t1 ^ t14;
+    W t18 = t10 ^ t13;
+    W t19 = t2 ^ t4;
+    W t20 = t3 ^ t18;
+    W t21 = t2 ^ t17;
+    W t22 = t11 ^ t16;
+    W t23 = t15 ^ t19;
+    W t24 = a3 & a4;
+    W t25 = t13 ^ t14 ^ t15;
+    W t26 = t9 ^ a5 ^ t2 ^ t3 ^ t22;
+    W t27 = t5 ^ a2 ^ t1 ^ t13;
+    W t28 = a2 ^ t15;
+    W t29 = t6 ^ t14 ^ t16;
+    W t30 = a6 ^ t22;
+    W t31 = t1 ^ t12 ^ t16 ^ t18;
+    W t32 = t8 ^ t10 ^ t21;
+    W t33 = t7 ^ t12 ^ t21;
+    W t34 = t1 ^ t23;
+    W t35 = a1 ^ t9 ^ t7 ^ t4 ^ t17;
+    W t36 = t6 ^ t20;
+    W t37 = t11 ^ t23 ^ t20;
+    o1 ^= ~t25 ^ (a4 & t26) ^ (a3 & ~t27);
+    o2 ^= ~t28 ^ (a4 & ~t29) ^ (a3 & t30) ^ (t24 & t6);
+    o3 ^= ~t31 ^ (a4 & ~t32) ^ (a3 & t33) ^ (t24 & ~t34);
+    o4 ^= ~t35 ^ (a4 & ~t36) ^ (a3 & ~t37);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox3(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a4 & a2;
+    W t2 = a5 & a2;
+    W t3 = a5 & a4;
+    W t4 = a6 & a2;
+    W t5 = a6 & a4;
+    W t6 = a6 & a5;
+    W t7 = t3 & a2;
+    W t8 = t5 & a2;
+    W t9 = t6 & a2;
+    W t10 = t6 & a4;
+    W t11 = t10 & a2;
+    W t12 = t1 ^ t10;
+    W t13 = t2 ^ t9;
+    W t14 = t5 ^ t12;
+    W t15 = t4 ^ t13;
+    W t16 = t3 ^ a6;
+    W t17 = a2 ^ a5;
+    W t18 = t8 ^ t14;
+    W t19 = a4 ^ t16;
+    W t20 = t7 ^ t14;
+    W t21 = a2 ^ t12;
+    W t22 = t11 ^ t19;
+    W t23 = t15 ^ t18;
+    W t24 = t6 ^ t18;
+    W t25 = t17 ^ t20;
+    W t26 = a4 ^ t13;
+    W t27 = t15 ^ t21;
+    W t28 = t4 ^ t17;
+    W t29 = t15 ^ t17;
+    W t30 = a1 & a3;
+    W t31 = t11 ^ t3 ^ t25;
+    W t32 = a5 ^ t12 ^ t26;
+    W t33 = a2 ^ t22 ^ t20;
+    W t34 = t6 ^ a4 ^ t21;
+    W t35 = t23 ^ t16;
+    W t36 = t1 ^ t29;
+    W t37 = a6 ^ t25 ^ t26;
+    W t38 = t24 ^ t28 ^ t19;
+    W t39 = t22 ^ t23;
+    W t40 = a5 ^ t24;
+    W t41 = a2 ^ t19;
+    W t42 = t5 ^ t29 ^ t16;
+    W t43 = t8 ^ t2 ^ t28;
+    o1 ^= ~t31 ^ (a3 & ~t32) ^ (a1 & t33) ^ (t30 & ~t34);
+    o2 ^= t35 ^ (a3 & ~t36) ^ (a1 & ~t27) ^ (t30 & t27);
+    o3 ^= ~t37 ^ (a3 & t38) ^ (a1 & ~t39) ^ (t30 & t40);
+    o4 ^= t41 ^ (a3 & a5) ^ (a1 & ~t42) ^ (t30 & ~t43);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox4(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a2 & a1;
+    W t2 = a3 & a1;
+    W t3 = a3 & a2;
+    W t4 = a5 & a1;
+    W t5 = a5 & a2;
+    W t6 = a5 & a3;
+    W t7 = t3 & a1;
+    W t8 = t5 & a1;
+    W t9 = t6 & a1;
+    W t10 = t6 & a2;
+    W t11 = t10 & a1;
+    W t12 = a1 ^ t3;
+    W t13 = a5 ^ t5;
+    W t14 = t4 ^ t9;
+    W t15 = t1 ^ t8;
+    W t16 = t2 ^ t12;
+    W t17 = t6 ^ t12;
+    W t18 = t11 ^ t13;
+    W t19 = t7 ^ t15;
+    W t20 = a2 ^ t14;
+    W t21 = a3 ^ t20;
+    W t22 = t14 ^ t17;
+    W t23 = t9 ^ t16;
+    W t24 = t10 ^ t18;
+    W t25 = t8 ^ t24;
+    W t26 = a2 ^ t18;
+    W t27 = t16 ^ t26;
+    W t28 = t5 ^ t19;
+    W t29 = a5 ^ t19;
+    W t30 = t7 ^ t27;
+    W t31 = t5 ^ t22;
+    W t32 = t4 ^ t30;
+    W t33 = t21 ^ t25;
+    W t34 = t13 ^ t23;
+    W t35 = a4 & a6;
+    W t36 = t25 ^ t17;
+    W t37 = a1 ^ t9 ^ t2 ^ t28;
+    W t38 = t17 ^ t21;
+    W t39 = t3 ^ t29;
+    W t40 = t11 ^ a5 ^ t15 ^ t21;
+    W t41 = t22 ^ t29;
+    W t42 = a3 ^ t23 ^ t28;
+    W t43 = t13 ^ t19;
+    o1 ^= t36 ^ (a6 & ~t33) ^ (a4 & ~t37) ^ (t35 & ~t34);
+    o2 ^= ~t38 ^ (a6 & t33) ^ (a4 & t39) ^ (t35 & ~t34);
+    o3 ^= ~t40 ^ (a6 & ~t32) ^ (a4 & t41) ^ (t35 & ~t31);
+    o4 ^= ~t42 ^ (a6 & t32) ^ (a4 & ~t43) ^ (t35 & ~t31);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox5(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a3 & a2;
+    W t2 = a4 & a2;
+    W t3 = a4 & a3;
+    W t4 = a6 & a2;
+    W t5 = a6 & a3;
+    W t6 = a6 & a4;
+    W t7 = t3 & a2;
+    W t8 = t5 & a2;
+    W t9 = t6 & a2;
+    W t10 = t6 & a3;
+    W t11 = t10 & a2;
+    W t12 = a4 ^ t10;
+    W t13 = t3 ^ a6;
+    W t14 = t2 ^ t8;
+    W t15 = a3 ^ t12;
+    W t16 = t5 ^ t9;
+    W t17 = t1 ^ t4;
+    W t18 = a2 ^ t17;
+    W t19 = t13 ^ t15;
+    W t20 = t6 ^ t16;
+    W t21 = t14 ^ t18;
+    W t22 = t7 ^ t11;
+    W t23 = t17 ^ t22;
+    W t24 = a2 ^ t20;
+    W t25 = t13 ^ t14;
+    W t26 = t5 ^ t15;
+    W t27 = a6 ^ t26;
+    W t28 = t2 ^ t16;
+    W t29 = t8 ^ t9;
+    W t30 = t3 ^ t12;
+    W t31 = t4 ^ t28;
+    W t32 = a1 & a5;
+    W t33 = t10 ^ t24 ^ t25;
+    W t34 = t12 ^ t25;
+    W t35 = a3 ^ t7 ^ t14 ^ t20;
+    W t36 = t13 ^ t31;
+    W t37 = t11 ^ t27 ^ t14;
+    W t38 = t5 ^ t10;
+    W t39 = t23 ^ t29;
+    W t40 = t6 ^ a4 ^ t13;
+    W t41 = t22 ^ t24 ^ t30;
+    W t42 = t19 ^ t21;
+    W t43 = t5 ^ t2 ^ t23 ^ t19;
+    W t44 = a2 ^ t29 ^ t19;
+    W t45 = t10 ^ a3 ^ t31;
+    W t46 = t16 ^ t18 ^ t19;
+    W t47 = t7 ^ t27 ^ t21;
+    W t48 = t30 ^ t21;
+    o1 ^= t33 ^ (a5 & ~t34) ^ (a1 & t35) ^ (t32 & ~t36);
+    o2 ^= t37 ^ (a5 & ~t38) ^ (a1 & ~t39) ^ (t32 & t40);
+    o3 ^= ~t41 ^ (a5 & ~t42) ^ (a1 & ~t43) ^ (t32 & t44);
+    o4 ^= t45 ^ (a5 & t46) ^ (a1 & t47) ^ (t32 & t48);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox6(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a3 & a1;
+    W t2 = a4 & a1;
+    W t3 = a4 & a3;
+    W t4 = a6 & a1;
+    W t5 = a6 & a3;
+    W t6 = a6 & a4;
+    W t7 = t3 & a1;
+    W t8 = t5 & a1;
+    W t9 = t6 & a1;
+    W t10 = t6 & a3;
+    W t11 = t10 & a1;
+    W t12 = t8 ^ t9;
+    W t13 = a3 ^ t12;
+    W t14 = t3 ^ t10;
+    W t15 = t1 ^ t6;
+    W t16 = a4 ^ a6;
+    W t17 = t4 ^ t14;
+    W t18 = t1 ^ t8;
+    W t19 = a1 ^ a3;
+    W t20 = t5 ^ t12;
+    W t21 = t15 ^ t17;
+    W t22 = t2 ^ t13;
+    W t23 = t7 ^ t11;
+    W t24 = t20 ^ t21;
+    W t25 = t2 ^ t15;
+    W t26 = t16 ^ t18;
+    W t27 = a2 & a5;
+    W t28 = a1 ^ t24 ^ t16;
+    W t29 = t10 ^ t11 ^ t13;
+    W t30 = t26 ^ t19;
+    W t31 = t3 ^ t7 ^ t22;
+    W t32 = t11 ^ a4 ^ t18;
+    W t33 = t8 ^ t25;
+    W t34 = t4 ^ t26;
+    W t35 = a1 ^ t13 ^ t15;
+    W t36 = t1 ^ t19;
+    W t37 = t22 ^ t16;
+    W t38 = t23 ^ t17 ^ t19;
+    W t39 = t9 ^ t23 ^ t25 ^ t14;
+    W t40 = a4 ^ t13 ^ t17;
+    W t41 = t6 ^ t9;
+    o1 ^= ~t24 ^ (a5 & ~t28) ^ (a2 & ~t29) ^ (t27 & t12);
+    o2 ^= ~t30 ^ (a5 & ~t31) ^ (a2 & ~t32) ^ (t27 & t33);
+    o3 ^= t34 ^ (a5 & t35) ^ (a2 & t36) ^ (t27 & t37);
+    o4 ^= t38 ^ (a5 & ~t39) ^ (a2 & t40) ^ (t27 & t41);
+}
+
+template <typename W>
+static DES_FORCE_INLINE void bsSbox7(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a3 & a2;
+    W t2 = a4 & a2;
+    W t3 = a4 & a3;
+    W t4 = a5 & a2;
+    W t5 = a5 & a3;
+    W t6 = a5 & a4;
+    W t7 = t3 & a2;
+    W t8 = t5 & a2;
+    W t9 = t6 & a2;
+    W t10 = t6 & a3;
+    W t11 = t1 ^ t10;
+    W t12 = a3 ^ a5;
+    W t13 = t7 ^ t11;
+    W t14 = t2 ^ t9;
+    W t15 = t6 ^ t12;
+    W t16 = a2 ^ a4;
+    W t17 = t5 ^ t8;
+    W t18 = a5 ^ t16;
+    W t19 = t7 ^ t10;
+    W t20 = t13 ^ t17;
+    W t21 = t9 ^ t15;
+    W t22 = t3 ^ t11;
+    W t23 = t1 ^ t14;
+    W t24 = a1 & a6;
+    W t25 = t2 ^ t12 ^ t13;
+    W t26 = t14 ^ t18 ^ t20;
+    W t27 = t13 ^ t15;
+    W t28 = t1 ^ t2 ^ t18;
+    W t29 = a2 ^ t9 ^ t10;
+    W t30 = a3 ^ t16 ^ t19;
+    W t31 = t21 ^ t16;
+    W t32 = t3 ^ t21 ^ t19;
+    W t33 = t12 ^ t23 ^ t17;
+    W t34 = t3 ^ a5 ^ t20;
+    W t35 = a2 ^ t22 ^ t15;
+    W t36 = t6 ^ a4 ^ t2 ^ t4 ^ t22;
+    o1 ^= t25 ^ (a6 & ~t13) ^ (a1 & t26) ^ (t24 & ~t27);
+    o2 ^= ~t28 ^ (a6 & t29) ^ (a1 & ~t30) ^ (t24 & ~t23);
+    o3 ^= t31 ^ (a6 & t32) ^ (a1 & t33) ^ (t24 & ~t34);
+    o4 ^= t35 ^ (a6 & ~t14) ^ a1 ^ (t24 & t36);
 }
 
-vector<int> ExpansionPBoxFun(vector<int> right) {
-    vector<int> ans(48);
-    for (int i = 0; i < 48; i++) {
-        ans[i] = right[ExpansionPBox[i]-1];
+template <typename W>
+static DES_FORCE_INLINE void bsSbox8(W a1, W a2, W a3, W a4, W a5, W a6, W& o1, W& o2, W& o3, W& o4) {
+    W t1 = a3 & a2;
+    W t2 = a4 & a2;
+    W t3 = a4 & a3;
+    W t4 = a5 & a2;
+    W t5 = a5 & a3;
+    W t6 = a5 & a4;
+    W t7 = t3 & a2;
+    W t8 = t5 & a2;
+    W t9 = t6 & a2;
+    W t10 = t6 & a3;
+    W t11 = t3 ^ t7;
+    W t12 = a5 ^ t5;
+    W t13 = t2 ^ t4;
+    W t14 = t1 ^ t9;
+    W t15 = t8 ^ t6;
+    W t16 = a4 ^ t12;
+    W t17 = t11 ^ t13;
+    W t18 = a5 ^ t9;
+    W t19 = a2 ^ t6;
+    W t20 = a3 ^ t14;
+    W t21 = a3 ^ t19;
+    W t22 = a2 ^ t14;
+    W t23 = t2 ^ t20;
+    W t24 = t5 ^ t17;
+    W t25 = a4 ^ t18;
+    W t26 = t4 ^ t16;
+    W t27 = t13 ^ t22;
+    W t28 = a1 & a6;
+    W t29 = a3 ^ t17 ^ t18;
+    W t30 = a4 ^ t17 ^ t19;
+    W t31 = t5 ^ t6 ^ t11;
+    W t32 = a5 ^ t11 ^ t23 ^ t15;
+    W t33 = t27 ^ t16;
+    W t34 = a4 ^ t24 ^ t20;
+    W t35 = t11 ^ t16;
+    W t36 = t12 ^ t21;
+    W t37 = t7 ^ t27;
+    W t38 = t26 ^ t15;
+    W t39 = t25 ^ t15;
+    W t40 = t21 ^ t25;
+    W t41 = t10 ^ t1 ^ t3 ^ t26;
+    W t42 = t8 ^ t12 ^ t23;
+    W t43 = t24 ^ t15;
+    o1 ^= ~t29 ^ (a6 & ~t30) ^ (a1 & ~t31) ^ (t28 & ~t32);
+    o2 ^= ~t33 ^ a6 ^ (a1 & t34) ^ (t28 & t35);
+    o3 ^= t36 ^ (a6 & t37) ^ (a1 & ~t38) ^ (t28 & t39);
+    o4 ^= ~t40 ^ (a6 & t41) ^ (a1 & t42) ^ (t28 & ~t43);
+}
+
+// Position in the round function output of each S-box output bit (the
+// inverse of P), so S-box results XOR straight into the left half
+struct DesPermInverse {
+    uint8_t pos[32];
+};
+
+constexpr DesPermInverse makePermInverse() {
+    DesPermInverse inv = {};
+    for (int i = 0; i < 32; i++) {
+        inv.pos[StraightPBox[i] - 1] = (uint8_t)i;
     }
-    return ans;
+    return inv;
+}
+
+static constexpr DesPermInverse pInv = makePermInverse();
+
+// XOR a key-bit mask into a plane; masks are stored as 64-bit words and
+// widened to both lanes at use in the SIMD kernel
+static DES_FORCE_INLINE uint64_t bsKey(uint64_t x, uint64_t k) {
+    return x ^ k;
 }
 
-vector<int> StraightPBoxFun(vector<int> right) {
-    vector<int> ans(32);
+#ifdef __wasm_simd128__
+static DES_FORCE_INLINE v128_t bsKey(v128_t x, uint64_t k) {
+    return wasm_v128_xor(x, wasm_i64x2_splat((int64_t)k));
+}
+#endif
+
+// l ^= f(r, k) on bit-planes; k holds the 48 round key bits as all-zero or
+// all-one words. S-box s reads r bits 4s-1..4s+4 (0-based, mod 32).
+template <typename W>
+static DES_FORCE_INLINE void bsFeistel(const W* r, W* l, const uint64_t* k) {
+    const uint8_t* p = pInv.pos;
+    bsSbox1(bsKey(r[31], k[0]), bsKey(r[0], k[1]), bsKey(r[1], k[2]),
+            bsKey(r[2], k[3]), bsKey(r[3], k[4]), bsKey(r[4], k[5]),
+            l[p[0]], l[p[1]], l[p[2]], l[p[3]]);
+    bsSbox2(bsKey(r[3], k[6]), bsKey(r[4], k[7]), bsKey(r[5], k[8]),
+            bsKey(r[6], k[9]), bsKey(r[7], k[10]), bsKey(r[8], k[11]),
+            l[p[4]], l[p[5]], l[p[6]], l[p[7]]);
+    bsSbox3(bsKey(r[7], k[12]), bsKey(r[8], k[13]), bsKey(r[9], k[14]),
+            bsKey(r[10], k[15]), bsKey(r[11], k[16]), bsKey(r[12], k[17]),
+            l[p[8]], l[p[9]], l[p[10]], l[p[11]]);
+    bsSbox4(bsKey(r[11], k[18]), bsKey(r[12], k[19]), bsKey(r[13], k[20]),
+            bsKey(r[14], k[21]), bsKey(r[15], k[22]), bsKey(r[16], k[23]),
+            l[p[12]], l[p[13]], l[p[14]], l[p[15]]);
+    bsSbox5(bsKey(r[15], k[24]), bsKey(r[16], k[25]), bsKey(r[17], k[26]),
+            bsKey(r[18], k[27]), bsKey(r[19], k[28]), bsKey(r[20], k[29]),
+            l[p[16]], l[p[17]], l[p[18]], l[p[19]]);
+    bsSbox6(bsKey(r[19], k[30]), bsKey(r[20], k[31]), bsKey(r[21], k[32]),
+            bsKey(r[22], k[33]), bsKey(r[23], k[34]), bsKey(r[24], k[35]),
+            l[p[20]], l[p[21]], l[p[22]], l[p[23]]);
+    bsSbox7(bsKey(r[23], k[36]), bsKey(r[24], k[37]), bsKey(r[25], k[38]),
+            bsKey(r[26], k[39]), bsKey(r[27], k[40]), bsKey(r[28], k[41]),
+            l[p[24]], l[p[25]], l[p[26]], l[p[27]]);
+    bsSbox8(bsKey(r[27], k[42]), bsKey(r[28], k[43]), bsKey(r[29], k[44]),
+            bsKey(r[30], k[45]), bsKey(r[31], k[46]), bsKey(r[0], k[47]),
+            l[p[28]], l[p[29]], l[p[30]], l[p[31]]);
+}
+
+// Key-bit masks for one DES pass, in the order the rounds use them
+using BsDesKeys = uint64_t[16][48];
+
+// IP, Stages passes of 16 rounds (swapping halves between passes) and FP
+// on 64 bit-planes, in place
+template <typename W, int Stages>
+static void bsDesPlanes(W* planes, const BsDesKeys* keys) {
+    W left[32], right[32];
+    W* l = left;
+    W* r = right;
+    for (int i = 0; i < 32; i++) {
+        l[i] = planes[InitialPermutation[i] - 1];
+        r[i] = planes[InitialPermutation[32 + i] - 1];
+    }
+    for (int s = 0; s < Stages; s++) {
+        if (s > 0) {
+            W* t = l;
+            l = r;
+            r = t;
+        }
+        for (int round = 0; round < 16; round += 2) {
+            bsFeistel(r, l, keys[s][round]);
+            bsFeistel(l, r, keys[s][round + 1]);
+        }
+    }
+    // FP is the inverse of IP, applied to R16 || L16
     for (int i = 0; i < 32; i++) {
-        ans[i] = right[StraightPBox[i]-1];
+        planes[InitialPermutation[i] - 1] = r[i];
+        planes[InitialPermutation[32 + i] - 1] = l[i];
+    }
+}
+
+// A schedule as key-bit masks for the bitsliced kernels
+void bsDesKeys(const DesSchedule& roundKeys, BsDesKeys& keys) {
+    for (int round = 0; round < 16; round++) {
+        for (int s = 0; s < 8; s++) {
+            uint32_t chunk = (roundKeys[round][(s & 1) ^ 1] >> (24 - 8 * (s >> 1))) & 63;
+            for (int b = 0; b < 6; b++) {
+                keys[round][6 * s + b] = 0 - (uint64_t)((chunk >> (5 - b)) & 1);
+            }
+        }
     }
-    return ans;
 }
 
-bitset<28> divideLeft(bitset<56> key) {
-    string left = "";
-    for (int i = 55; i >= 28; i--) {
-        left += to_string(key[i]);
+// Transpose a 64x64 bit matrix in place (bit 63 - j of a[i] <-> bit 63 - i
+// of a[j]); turns 64 blocks into 64 bit-planes and back
+static void transpose64(uint64_t* a) {
+    uint64_t m = 0x00000000ffffffffULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = (a[k] ^ (a[k | j] >> j)) & m;
+            a[k] ^= t;
+            a[k | j] ^= t << j;
+        }
     }
-    return bitset<28>(left);
 }
 
-bitset<28> divideRight(bitset<56> key) {
-    string right = "";
-    for (int i = 27; i >= 0; i--) {
-        right += to_string(key[i]);
+// 64 blocks in one pass of the uint64_t kernel
+template <int Stages>
+void desBitslice64(const uint8_t* in, uint8_t* out, const BsDesKeys* keys) {
+    uint64_t planes[64];
+    for (int i = 0; i < 64; i++) {
+        planes[i] = loadBlock(in + 8 * i);
+    }
+    transpose64(planes);
+    bsDesPlanes<uint64_t, Stages>(planes, keys);
+    transpose64(planes);
+    for (int i = 0; i < 64; i++) {
+        storeBlock(out + 8 * i, planes[i]);
     }
-    return bitset<28>(right);
 }
 
-vector<int> divideLeft(bitset<64> key) {
-    vector<int> left;
-    for (int i = 63; i >= 32; i--) {
-        left.push_back(key[i]);
+#ifdef __wasm_simd128__
+// 128 blocks in one pass: each v128_t plane carries blocks 0-63 in lane 0
+// and blocks 64-127 in lane 1
+template <int Stages>
+void desBitslice128(const uint8_t* in, uint8_t* out, const BsDesKeys* keys) {
+    uint64_t lo[64];
+    uint64_t hi[64];
+    v128_t planes[64];
+    for (int i = 0; i < 64; i++) {
+        lo[i] = loadBlock(in + 8 * i);
+        hi[i] = loadBlock(in + 8 * (64 + i));
+    }
+    transpose64(lo);
+    transpose64(hi);
+    for (int i = 0; i < 64; i++) {
+        planes[i] = wasm_i64x2_make((int64_t)lo[i], (int64_t)hi[i]);
+    }
+    bsDesPlanes<v128_t, Stages>(planes, keys);
+    for (int i = 0; i < 64; i++) {
+        lo[i] = (uint64_t)wasm_i64x2_extract_lane(planes[i], 0);
+        hi[i] = (uint64_t)wasm_i64x2_extract_lane(planes[i], 1);
+    }
+    transpose64(lo);
+    transpose64(hi);
+    for (int i = 0; i < 64; i++) {
+        storeBlock(out + 8 * i, lo[i]);
+        storeBlock(out + 8 * (64 + i), hi[i]);
     }
-    return left;
 }
+#endif
 
-vector<int> divideRight(bitset<64> key) {
-    vector<int> right;
-    for (int i = 31; i >= 0; i--) {
-        right.push_back(key[i]);
+// nblocks blocks through the DES passes in stages: bitsliced passes while
+// enough blocks remain, then the table-driven path for the tail
+template <int Stages>
+void desBlocks(const uint8_t* in, uint8_t* out, int nblocks, const DesSchedule* const* stages) {
+    int i = 0;
+    if (nblocks >= DES_BITSLICE_BLOCKS) {
+        BsDesKeys keys[Stages];
+        for (int s = 0; s < Stages; s++) {
+            bsDesKeys(*stages[s], keys[s]);
+        }
+#ifdef __wasm_simd128__
+        for (; i + DES_BITSLICE_WIDE_BLOCKS <= nblocks; i += DES_BITSLICE_WIDE_BLOCKS) {
+            desBitslice128<Stages>(in + 8 * i, out + 8 * i, keys);
+        }
+#endif
+        for (; i + DES_BITSLICE_BLOCKS <= nblocks; i += DES_BITSLICE_BLOCKS) {
+            desBitslice64<Stages>(in + 8 * i, out + 8 * i, keys);
+        }
+    }
+    for (; i < nblocks; i++) {
+        desBlock<Stages>(in + 8 * i, out + 8 * i, stages);
     }
-    return right;
 }
 
-bitset<56> Combine(bitset<28> left, bitset<28> right) {
-    string temp = "";
-    for (int i = 55; i >= 28; i--) {
-        temp += to_string(left[i-28]);
+// DES for the mode layer in block_modes.h
+struct DesBlockCipher {
+    static constexpr int blockSize = 8;
+    DesSchedule encKeys;
+    DesSchedule decKeys;
+
+    explicit DesBlockCipher(const uint8_t* key) {
+        desKeySchedule(key, encKeys);
+        desReverseSchedule(encKeys, decKeys);
+    }
+
+    void encryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        const DesSchedule* stages[1] = {&encKeys};
+        desBlocks<1>(input, output, nblocks, stages);
+    }
+    void decryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        const DesSchedule* stages[1] = {&decKeys};
+        desBlocks<1>(input, output, nblocks, stages);
+    }
+};
+
+// Triple DES (EDE) for the mode layer. A 16-byte key is two-key EDE2
+// (K3 = K1), a 24-byte key three-key EDE3. Encryption is E(K1), D(K2),
+// E(K3) run back to back on each block; decryption is the reverse.
+struct TdesBlockCipher {
+    static constexpr int blockSize = 8;
+    DesSchedule encKeys[3];
+    DesSchedule decKeys[3];
+
+    // keyLen must be 16 or 24
+    TdesBlockCipher(const uint8_t* key, int keyLen) {
+        for (int i = 0; i < 3; i++) {
+            const uint8_t* k = (i == 2 && keyLen == 16) ? key : key + 8 * i;
+            desKeySchedule(k, encKeys[i]);
+            desReverseSchedule(encKeys[i], decKeys[i]);
+        }
+    }
+
+    void encryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        const DesSchedule* stages[3] = {&encKeys[0], &decKeys[1], &encKeys[2]};
+        desBlocks<3>(input, output, nblocks, stages);
     }
-    for (int i = 27; i >= 0; i--) {
-        temp += to_string(right[i]);
+    void decryptBlocks(const uint8_t* input, uint8_t* output, int nblocks) const {
+        const DesSchedule* stages[3] = {&decKeys[2], &encKeys[1], &decKeys[0]};
+        desBlocks<3>(input, output, nblocks, stages);
     }
-    return bitset<56>(temp);
+};
+
+// --- Key search ---
+//
+// Exhaustive search for the key bits under a mask, given one known
+// plaintext/ciphertext pair. Candidates are bitsliced across keys rather than
+// blocks: the 64 lanes of a pass share the plaintext and differ in the key,
+// so the uint64_t kernel tests 64 keys at a time. The six lowest unknown key
+// bits select the lane; the remaining unknown bits are walked in Gray-code
+// order, so moving to the next pass flips one key bit and only the round-key
+// masks that bit feeds are updated.
+
+// Key bits (0 = most significant) that feed each round-key bit, and for each
+// key bit the round-key positions (round * 48 + bit) it feeds. Parity bits
+// feed nothing.
+struct DesKeyBits {
+    uint8_t source[16][48];
+    uint16_t uses[64][16];
+    uint8_t useCount[64];
+};
+
+constexpr DesKeyBits makeDesKeyBits() {
+    DesKeyBits t = {};
+    int shift = 0;
+    for (int round = 0; round < 16; round++) {
+        shift += keyShifts[round];
+        for (int i = 0; i < 48; i++) {
+            int x = CompressionPBox[i] - 1;
+            int half = (x < 28) ? 0 : 28;
+            int bit = parityTable[half + (x - half + shift) % 28] - 1;
+            t.source[round][i] = (uint8_t)bit;
+            t.uses[bit][t.useCount[bit]++] = (uint16_t)(round * 48 + i);
+        }
+    }
+    return t;
 }
 
-bitset<28> circularLeftShift(bitset<28>& bits, int shift) {
-    return (bits << shift) | (bits >> (28 - shift));
+static constexpr DesKeyBits desKeyBits = makeDesKeyBits();
+
+// Candidate keys per work item handed to the thread pool
+#define DES_SEARCH_ITEM_PASSES 256
+
+// Work items one des_key_search_step() call schedules at most (2^34 keys), so
+// the item count fits an int; a larger max_keys is covered over several calls
+#define DES_SEARCH_MAX_ITEMS (1 << 20)
+
+// Search states returned by des_key_search_step() and des_key_search_status()
+#define DES_SEARCH_RUNNING 1
+#define DES_SEARCH_FOUND 2
+#define DES_SEARCH_EXHAUSTED 3
+
+struct DesKeySearch {
+    uint64_t plainPlanes[64];   // plaintext bit i as an all-zero/all-one word
+    uint64_t cipherPlanes[64];
+    uint8_t plaintext[8];
+    uint8_t ciphertext[8];
+    uint64_t baseKey;           // known key bits, unknown bits cleared
+    int unknownBits[56];        // unknown key bit positions, lane bits first
+    int unknownCount;
+    int laneBits;
+    uint64_t passes;            // 2^(unknownCount - laneBits)
+    uint64_t nextPass;
+    std::atomic<uint64_t> passesDone;
+    std::atomic<bool> found;
+    uint64_t foundKey;
+    std::mutex foundMutex;
+    double seconds;
+};
+
+static inline uint64_t keyBitMask(int bit) {
+    return 1ULL << (63 - bit);
 }
 
-vector<bitset<48>> KeyGeneration(bitset<56> key) {
-    bitset<28> lefthalf = divideLeft(key);
-    bitset<28> righthalf = divideRight(key);
-    
-    vector<bitset<56>> roundKeys;
-    
-    int leftShiftCount = 0;
-    for (int i = 0; i < 16; i++) {
-        if (i == 0 || i == 1 || i == 8 || i == 15) {
-            leftShiftCount = 1;
+// The key tested by lane `lane` of the pass whose high unknown bits are gray
+static uint64_t searchCandidate(const DesKeySearch* s, uint64_t gray, int lane) {
+    uint64_t key = s->baseKey;
+    for (int t = 0; t < s->unknownCount; t++) {
+        uint64_t v = (t < s->laneBits) ? (uint64_t)(lane >> t) : gray >> (t - s->laneBits);
+        if (v & 1) key |= keyBitMask(s->unknownBits[t]);
+    }
+    return key;
+}
+
+// Test passes [first, last). Returns the number of passes completed, which
+// is short if another item found the key first.
+static uint64_t searchPasses(DesKeySearch* s, uint64_t first, uint64_t last) {
+    // Each key bit as a lane word: fixed for known bits, a lane pattern for
+    // the lane bits, and all-zero/all-one by the Gray code for the rest
+    static const uint64_t lanePattern[6] = {
+        0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+        0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL
+    };
+    uint64_t keyWords[64];
+    uint64_t gray = first ^ (first >> 1);
+    for (int bit = 0; bit < 64; bit++) {
+        keyWords[bit] = (s->baseKey & keyBitMask(bit)) ? ~0ULL : 0;
+    }
+    for (int t = 0; t < s->unknownCount; t++) {
+        int bit = s->unknownBits[t];
+        if (t < s->laneBits) {
+            keyWords[bit] = lanePattern[t];
         } else {
-            leftShiftCount = 2;
+            keyWords[bit] = ((gray >> (t - s->laneBits)) & 1) ? ~0ULL : 0;
+        }
+    }
+
+    BsDesKeys keys;
+    for (int round = 0; round < 16; round++) {
+        for (int i = 0; i < 48; i++) {
+            keys[round][i] = keyWords[desKeyBits.source[round][i]];
+        }
+    }
+
+    uint64_t planes[64];
+    for (uint64_t pass = first; pass < last; pass++) {
+        if (pass != first) {
+            // Gray code step: exactly one high unknown bit flips
+            int t = s->laneBits + __builtin_ctzll(pass);
+            int bit = s->unknownBits[t];
+            gray ^= 1ULL << (t - s->laneBits);
+            for (int u = 0; u < desKeyBits.useCount[bit]; u++) {
+                int pos = desKeyBits.uses[bit][u];
+                keys[pos / 48][pos % 48] = ~keys[pos / 48][pos % 48];
+            }
+        }
+        if ((pass & 15) == 0 && s->found.load(std::memory_order_relaxed)) {
+            return pass - first;
+        }
+
+        for (int i = 0; i < 64; i++) {
+            planes[i] = s->plainPlanes[i];
         }
-        lefthalf = circularLeftShift(lefthalf, leftShiftCount);
-        righthalf = circularLeftShift(righthalf, leftShiftCount);
-        
-        bitset<56> temp = Combine(lefthalf, righthalf);
-        roundKeys.push_back(temp);
+        bsDesPlanes<uint64_t, 1>(planes, &keys);
+        uint64_t mismatch = 0;
+        for (int i = 0; i < 64; i++) {
+            mismatch |= planes[i] ^ s->cipherPlanes[i];
+        }
+
+        uint64_t match = ~mismatch;
+        while (match) {
+            int lane = __builtin_ctzll(match);
+            match &= match - 1;
+            // Confirm on the table-driven path before reporting
+            uint8_t keyBytes[8];
+            uint8_t check[8];
+            storeBlock(keyBytes, searchCandidate(s, gray, lane));
+            DesBlockCipher cipher(keyBytes);
+            cipher.encryptBlocks(s->plaintext, check, 1);
+            bool same = true;
+            for (int j = 0; j < 8; j++) {
+                same = same && check[j] == s->ciphertext[j];
+            }
+            if (same) {
+                std::lock_guard<std::mutex> lock(s->foundMutex);
+                if (!s->found.load()) {
+                    s->foundKey = loadBlock(keyBytes);
+                    s->found.store(true);
+                }
+                return pass - first + 1;
+            }
+        }
+    }
+    return last - first;
+}
+
+extern "C" {
+
+EMSCRIPTEN_KEEPALIVE
+int process_des(const uint8_t* data, int data_len, const uint8_t* key, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!data || !key || !output) {
+        return 0;
     }
     
-    vector<bitset<48>> ans(16);
-    for (int i = 0; i < 16; i++) {
-        ans[i] = CompressionPBoxFun(roundKeys[i]);
+    if (data_len <= 0 || data_len % 8 != 0) {
+        return 0;
     }
-    return ans;
+    
+    DesBlockCipher cipher(key);
+    processMode(cipher, MODE_ECB, nullptr, data, output, data_len, encrypt);
+    
+    return 1; // Success
 }
 
-vector<int> Xor(vector<int> a, vector<int> b) {
-    vector<int> ans(a.size());
-    for (int i = 0; i < ans.size(); i++) {
-        ans[i] = a[i] ^ b[i];
+// ECB, CBC, CFB, OFB or CTR (mode 0-4, see block_modes.h) with an 8-byte
+// key. ECB and CBC need a multiple of 8 bytes; the other modes take any
+// length. iv is 8 bytes (ignored for ECB) and is updated in place so a
+// further call continues the same message. output may alias data.
+EMSCRIPTEN_KEEPALIVE
+int process_des_mode(const uint8_t* data, int data_len, const uint8_t* key, uint8_t* iv, int mode, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!data || !key || !output || (!iv && mode != MODE_ECB)) {
+        return 0;
+    }
+    
+    if (data_len <= 0) {
+        return 0;
     }
-    return ans;
+    
+    DesBlockCipher cipher(key);
+    if (!processMode(cipher, mode, iv, data, output, data_len, encrypt)) {
+        return 0; // Error: unknown mode or data length not a multiple of 8
+    }
+    
+    return 1; // Success
 }
 
-vector<int> s_box_substitution(const vector<int>& input) {
-    vector<int> output(32);
-    for (int i = 0; i < 8; ++i) {
-        vector<int> block(input.begin() + i * 6, input.begin() + (i + 1) * 6);
-        int row = (block[0] << 1) | block[5];
-        int col = (block[1] << 3) | (block[2] << 2) | (block[3] << 1) | block[4];
-        int s_value = S_BOXES[i][row][col];
-        for (int j = 0; j < 4; ++j) {
-            output[i * 4 + j] = (s_value >> (3 - j)) & 1;
-        }
+// Run the key schedule once into a context for des_context_process().
+// Returns a handle, or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+DesBlockCipher* des_create_context(const uint8_t* key) {
+    if (!key) {
+        return 0;
     }
-    return output;
+    
+    return new (std::nothrow) DesBlockCipher(key);
 }
 
-vector<int> des_round(vector<int> left, vector<int> right, bitset<48> keys) {
-    vector<int> key(48);
-    for (int i = 47; i >= 0; i--) {
-        key[47-i] = keys[i];
+// process_des_mode() with the schedule cached in ctx
+EMSCRIPTEN_KEEPALIVE
+int des_context_process(const DesBlockCipher* ctx, const uint8_t* data, int data_len, uint8_t* iv, int mode, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!ctx || !data || !output || (!iv && mode != MODE_ECB)) {
+        return 0;
+    }
+    
+    if (data_len <= 0) {
+        return 0;
     }
     
-    vector<int> expanded_right = ExpansionPBoxFun(right);
-    vector<int> xor_result = Xor(expanded_right, key);
-    vector<int> s_box_result = s_box_substitution(xor_result);
-    vector<int> straight_P_box_result = StraightPBoxFun(s_box_result);
+    if (!processMode(*ctx, mode, iv, data, output, data_len, encrypt)) {
+        return 0; // Error: unknown mode or data length not a multiple of 8
+    }
     
-    return straight_P_box_result;
+    return 1; // Success
 }
 
-bitset<64> Encrypt(bitset<64> plaintext, vector<bitset<48>> keys) {
-    bitset<64> ipplaintext = initialbox(plaintext);
-    vector<int> left = divideLeft(ipplaintext);
-    vector<int> right = divideRight(ipplaintext);
+// Wipe and release a context from des_create_context()
+EMSCRIPTEN_KEEPALIVE
+int des_destroy_context(DesBlockCipher* ctx) {
+    if (!ctx) {
+        return 0;
+    }
     
-    for (int i = 0; i < 16; ++i) {
-        vector<int> new_right = Xor(left, des_round(left, right, keys[i]));
-        left = right;
-        right = new_right;
+    volatile uint8_t* wipe = (volatile uint8_t*)ctx;
+    for (unsigned i = 0; i < sizeof(DesBlockCipher); i++) {
+        wipe[i] = 0;
     }
-    vector<int> combined(right);
-    combined.insert(combined.end(), left.begin(), left.end());
-    string temp = "";
-    for (int i = 0; i < 64; i++) {
-        temp += to_string(combined[i]);
+    delete ctx;
+    return 1; // Success
+}
+
+// Triple DES ECB. key_len is 16 (two-key EDE2) or 24 (three-key EDE3).
+EMSCRIPTEN_KEEPALIVE
+int process_3des(const uint8_t* data, int data_len, const uint8_t* key, int key_len, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!data || !key || !output) {
+        return 0;
+    }
+    
+    if (data_len <= 0 || data_len % 8 != 0) {
+        return 0;
+    }
+    
+    if (key_len != 16 && key_len != 24) {
+        return 0; // Error: invalid key length
     }
-    bitset<64> combinedbit(temp);
-    return finalbox(combinedbit);
+    
+    TdesBlockCipher cipher(key, key_len);
+    processMode(cipher, MODE_ECB, nullptr, data, output, data_len, encrypt);
+    
+    return 1; // Success
 }
 
-bitset<64> Decrypt(bitset<64> plaintext, vector<bitset<48>> keys) {
-    bitset<64> ipplaintext = initialbox(plaintext);
-    vector<int> left = divideLeft(ipplaintext);
-    vector<int> right = divideRight(ipplaintext);
+// Triple DES in any mode (0-4, see block_modes.h); otherwise as
+// process_des_mode. key_len is 16 (EDE2) or 24 (EDE3).
+EMSCRIPTEN_KEEPALIVE
+int process_3des_mode(const uint8_t* data, int data_len, const uint8_t* key, int key_len, uint8_t* iv, int mode, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!data || !key || !output || (!iv && mode != MODE_ECB)) {
+        return 0;
+    }
     
-    for (int i = 15; i >= 0; i--) {
-        vector<int> new_right = Xor(left, des_round(left, right, keys[i]));
-        left = right;
-        right = new_right;
+    if (data_len <= 0) {
+        return 0;
     }
-    vector<int> combined(right);
-    combined.insert(combined.end(), left.begin(), left.end());
-    string temp = "";
-    for (int i = 0; i < 64; i++) {
-        temp += to_string(combined[i]);
+    
+    if (key_len != 16 && key_len != 24) {
+        return 0; // Error: invalid key length
+    }
+    
+    TdesBlockCipher cipher(key, key_len);
+    if (!processMode(cipher, mode, iv, data, output, data_len, encrypt)) {
+        return 0; // Error: unknown mode or data length not a multiple of 8
     }
-    bitset<64> combinedbit(temp);
-    return finalbox(combinedbit);
+    
+    return 1; // Success
 }
 
-// Convert bytes to bitset
-bitset<64> bytesToBitset(const uint8_t* bytes) {
-    bitset<64> result;
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            result[i * 8 + j] = (bytes[i] >> (7 - j)) & 1;
-        }
+// Expand all three 3DES schedules once into a context for
+// tdes_context_process(). Returns a handle, or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+TdesBlockCipher* tdes_create_context(const uint8_t* key, int key_len) {
+    if (!key || (key_len != 16 && key_len != 24)) {
+        return 0;
+    }
+    
+    return new (std::nothrow) TdesBlockCipher(key, key_len);
+}
+
+// process_3des_mode() with the schedules cached in ctx
+EMSCRIPTEN_KEEPALIVE
+int tdes_context_process(const TdesBlockCipher* ctx, const uint8_t* data, int data_len, uint8_t* iv, int mode, uint8_t* output, bool encrypt) {
+    // Safety checks
+    if (!ctx || !data || !output || (!iv && mode != MODE_ECB)) {
+        return 0;
+    }
+    
+    if (data_len <= 0) {
+        return 0;
+    }
+    
+    if (!processMode(*ctx, mode, iv, data, output, data_len, encrypt)) {
+        return 0; // Error: unknown mode or data length not a multiple of 8
+    }
+    
+    return 1; // Success
+}
+
+// Wipe and release a context from tdes_create_context()
+EMSCRIPTEN_KEEPALIVE
+int tdes_destroy_context(TdesBlockCipher* ctx) {
+    if (!ctx) {
+        return 0;
+    }
+    
+    volatile uint8_t* wipe = (volatile uint8_t*)ctx;
+    for (unsigned i = 0; i < sizeof(TdesBlockCipher); i++) {
+        wipe[i] = 0;
     }
-    return result;
+    delete ctx;
+    return 1; // Success
 }
 
-// Convert bitset to bytes
-void bitsetToBytes(const bitset<64>& bits, uint8_t* bytes) {
+// Start a search for the key that encrypts plaintext to ciphertext (8 bytes
+// each). Bits set in mask (8 bytes, same layout as the key) are unknown and
+// searched; the rest are taken from key. Parity bits are ignored either way.
+// Returns a handle for des_key_search_step(), or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+DesKeySearch* des_key_search_create(const uint8_t* plaintext, const uint8_t* ciphertext, const uint8_t* key, const uint8_t* mask) {
+    if (!plaintext || !ciphertext || !key || !mask) {
+        return 0;
+    }
+    
+    DesKeySearch* s = new (std::nothrow) DesKeySearch();
+    if (!s) {
+        return 0;
+    }
+    
+    uint64_t pt = loadBlock(plaintext);
+    uint64_t ct = loadBlock(ciphertext);
+    uint64_t unknown = loadBlock(mask);
+    for (int i = 0; i < 64; i++) {
+        s->plainPlanes[i] = (pt & keyBitMask(i)) ? ~0ULL : 0;
+        s->cipherPlanes[i] = (ct & keyBitMask(i)) ? ~0ULL : 0;
+    }
     for (int i = 0; i < 8; i++) {
-        bytes[i] = 0;
-        for (int j = 0; j < 8; j++) {
-            bytes[i] |= (bits[i * 8 + j] << (7 - j));
+        s->plaintext[i] = plaintext[i];
+        s->ciphertext[i] = ciphertext[i];
+    }
+    
+    s->unknownCount = 0;
+    for (int bit = 63; bit >= 0; bit--) {
+        if (bit % 8 != 7 && (unknown & keyBitMask(bit))) {
+            s->unknownBits[s->unknownCount++] = bit;
         }
     }
+    s->baseKey = loadBlock(key);
+    for (int t = 0; t < s->unknownCount; t++) {
+        s->baseKey &= ~keyBitMask(s->unknownBits[t]);
+    }
+    s->laneBits = (s->unknownCount < 6) ? s->unknownCount : 6;
+    s->passes = 1ULL << (s->unknownCount - s->laneBits);
+    s->nextPass = 0;
+    s->passesDone = 0;
+    s->found = false;
+    s->foundKey = 0;
+    s->seconds = 0;
+    return s;
 }
 
-extern "C" {
-
+// Test up to max_keys more candidates (rounded up to whole passes of 64, and
+// at most 2^34 per call), spread over the thread pool, stopping early once
+// the key turns up.
+// Returns DES_SEARCH_RUNNING, DES_SEARCH_FOUND or DES_SEARCH_EXHAUSTED, or
+// 0 on error.
 EMSCRIPTEN_KEEPALIVE
-int process_des(const uint8_t* data, int data_len, const uint8_t* key, uint8_t* output, bool encrypt) {
-    // Safety checks
-    if (!data || !key || !output) {
+int des_key_search_step(DesKeySearch* s, double max_keys) {
+    if (!s || max_keys <= 0) {
         return 0;
     }
     
-    if (data_len <= 0 || data_len % 8 != 0) {
+    if (s->found.load()) {
+        return DES_SEARCH_FOUND;
+    }
+    
+    uint64_t remaining = s->passes - s->nextPass;
+    double wanted = max_keys / (double)(1ULL << s->laneBits);
+    uint64_t n = (wanted >= (double)remaining) ? remaining : (uint64_t)wanted;
+    if (n == 0 && remaining > 0) {
+        n = 1;
+    }
+    if (n > (uint64_t)DES_SEARCH_MAX_ITEMS * DES_SEARCH_ITEM_PASSES) {
+        n = (uint64_t)DES_SEARCH_MAX_ITEMS * DES_SEARCH_ITEM_PASSES;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t first = s->nextPass;
+    int items = (int)((n + DES_SEARCH_ITEM_PASSES - 1) / DES_SEARCH_ITEM_PASSES);
+    parallelFor(items, [&](int i) {
+        uint64_t begin = first + (uint64_t)i * DES_SEARCH_ITEM_PASSES;
+        uint64_t end = begin + DES_SEARCH_ITEM_PASSES;
+        if (end > first + n) end = first + n;
+        if (s->found.load(std::memory_order_relaxed)) return;
+        s->passesDone += searchPasses(s, begin, end);
+    });
+    s->nextPass += n;
+    s->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (s->found.load()) {
+        return DES_SEARCH_FOUND;
+    }
+    return (s->nextPass == s->passes) ? DES_SEARCH_EXHAUSTED : DES_SEARCH_RUNNING;
+}
+
+// Progress of a search. stats (4 doubles, may be null) receives keys tested,
+// keys in the space, keys per second and seconds spent in
+// des_key_search_step(); key_out (8 bytes, may be null) receives the key once
+// found. Returns the state as des_key_search_step() does, or 0 on error.
+EMSCRIPTEN_KEEPALIVE
+int des_key_search_status(const DesKeySearch* s, double* stats, uint8_t* key_out) {
+    if (!s) {
         return 0;
     }
     
-    // Convert key to bitset
-    bitset<64> keyBits = bytesToBitset(key);
-    bitset<56> key56 = parityDrop(keyBits);
-    vector<bitset<48>> roundKeys = KeyGeneration(key56);
+    if (stats) {
+        double lanes = (double)(1ULL << s->laneBits);
+        stats[0] = (double)s->passesDone.load() * lanes;
+        stats[1] = (double)s->passes * lanes;
+        stats[2] = (s->seconds > 0) ? stats[0] / s->seconds : 0;
+        stats[3] = s->seconds;
+    }
     
-    // Process each 8-byte block
-    for (int i = 0; i < data_len; i += 8) {
-        bitset<64> blockBits = bytesToBitset(data + i);
-        bitset<64> result;
-        
-        if (encrypt) {
-            result = Encrypt(blockBits, roundKeys);
-        } else {
-            result = Decrypt(blockBits, roundKeys);
+    if (s->found.load()) {
+        if (key_out) {
+            storeBlock(key_out, s->foundKey);
         }
-        
-        bitsetToBytes(result, output + i);
+        return DES_SEARCH_FOUND;
+    }
+    return (s->nextPass == s->passes) ? DES_SEARCH_EXHAUSTED : DES_SEARCH_RUNNING;
+}
+
+// Release a search from des_key_search_create()
+EMSCRIPTEN_KEEPALIVE
+int des_key_search_destroy(DesKeySearch* s) {
+    if (!s) {
+        return 0;
     }
     
+    delete s;
     return 1; // Success
 }
 
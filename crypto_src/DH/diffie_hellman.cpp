@@ -1,31 +1,76 @@
 // crypto_src/DH/diffie_hellman.cpp
 #include <string>
+#include <cstdlib>
+#include <cstring>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#include "../Common/bigint.h"
 
 typedef long long int ll;
 
-// Modular exponentiation: (base^exp) % mod
-ll power(ll base, ll exp, ll mod) {
-    ll res = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp % 2 == 1) res = (res * base) % mod;
-        base = (base * base) % mod;
-        exp /= 2;
+// base^exp mod p for decimal (or 0x-prefixed hex) strings, as a malloc'd
+// decimal string for the JS caller. exp is a private key, so the
+// exponentiation is constant-time. Returns 0 on a malformed or zero p.
+static const char* powerString(const char* base_str, const char* exp_str, const char* p_str) {
+    BigInt base, exp, p, res;
+    if (!bigFromString(base_str, base) || !bigFromString(exp_str, exp) || !bigFromString(p_str, p)) {
+        return 0; // Error: not a number
     }
-    return res;
+    if (!bigPowMod(base, exp, p, res, true)) {
+        return 0; // Error: zero modulus
+    }
+
+    std::string result = bigToString(res);
+    char* return_string = (char*)malloc(result.length() + 1);
+    strncpy(return_string, result.c_str(), result.length());
+    return_string[result.length()] = '\0';
+    return return_string;
+}
+
+// base^exp mod p for 64-bit operands, constant-time in exp. Returns 0 for a
+// negative operand or p < 1.
+static ll powerU64(ll base, ll exp, ll p) {
+    if (base < 0 || exp < 0 || p < 1) {
+        return 0; // Error: out of range
+    }
+    BigInt b, e, m, res;
+    bigSetU64(b, (uint64_t)base);
+    bigSetU64(e, (uint64_t)exp);
+    bigSetU64(m, (uint64_t)p);
+    if (!bigPowMod(b, e, m, res, true)) {
+        return 0; // Error: zero modulus
+    }
+    uint64_t v = 0;
+    for (int i = res.size - 1; i >= 0; i--) v = (v << 32) | res.limb[i];
+    return (ll)v;
 }
 
 extern "C" {
-    // Calculates a public key: g^private_key mod p
+    // Calculates a public key: g^private_key mod p, for decimal or hex strings
+    EMSCRIPTEN_KEEPALIVE
+    const char* dh_public_key(const char* g, const char* p, const char* private_key) {
+        return powerString(g, private_key, p);
+    }
+
+    // Calculates the shared secret: other_public_key^private_key mod p, for
+    // decimal or hex strings
+    EMSCRIPTEN_KEEPALIVE
+    const char* dh_shared_secret(const char* other_public_key, const char* p, const char* private_key) {
+        return powerString(other_public_key, private_key, p);
+    }
+
+    // The original 64-bit interface, with its signatures unchanged so
+    // existing builds and callers keep working
     EMSCRIPTEN_KEEPALIVE
     ll generate_dh_public_key(ll g, ll p, ll private_key) {
-        return power(g, private_key, p);
+        return powerU64(g, private_key, p);
     }
 
-    // Calculates the shared secret: other_public_key^private_key mod p
     EMSCRIPTEN_KEEPALIVE
     ll calculate_dh_shared_secret(ll other_public_key, ll p, ll private_key) {
-        return power(other_public_key, private_key, p);
+        return powerU64(other_public_key, private_key, p);
     }
-}
\ No newline at end of file
+}
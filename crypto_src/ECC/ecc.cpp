@@ -1,83 +1,290 @@
 // crypto_src/ECC/ecc.cpp
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <sys/random.h>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#include "../Common/ec_curve.h"
 
-// Using a small, specific curve for demonstration: y^2 = x^3 + 7 (mod 3851)
-typedef long long int ll;
-const ll P = 3851; // A prime modulus
-const ll A = 0;
+// Copy a string into malloc'd memory for the JS caller
+static const char* toCString(const std::string& result) {
+    char* c_str = (char*)malloc(result.length() + 1);
+    strncpy(c_str, result.c_str(), result.length());
+    c_str[result.length()] = '\0';
+    return c_str;
+}
+
+// --- X25519 (RFC 7748) ---
+// Elements of GF(2^255 - 19) are five 51-bit limbs, h = sum h[i] * 2^(51i).
+// Sums and differences are left uncarried; a multiply accepts limbs up to
+// 2^54 and carries its result back under 2^52.
+typedef uint64_t FieldElement[5];
+typedef unsigned __int128 u128;
+
+static const uint64_t LIMB_MASK = (1ULL << 51) - 1;
+
+static inline void feCopy(FieldElement out, const FieldElement a) {
+    for (int i = 0; i < 5; i++) out[i] = a[i];
+}
+
+static inline void feAdd(FieldElement out, const FieldElement a, const FieldElement b) {
+    for (int i = 0; i < 5; i++) out[i] = a[i] + b[i];
+}
+
+// a - b + 2p, so b's limbs must stay under 2^52
+static inline void feSub(FieldElement out, const FieldElement a, const FieldElement b) {
+    out[0] = a[0] + 0xfffffffffffdaULL - b[0];
+    for (int i = 1; i < 5; i++) out[i] = a[i] + 0xffffffffffffeULL - b[i];
+}
 
-struct Point { ll x, y; };
+// Fold the 128-bit column sums into five limbs; 2^255 = 19 (mod p)
+static inline void feCarry(FieldElement out, u128 t0, u128 t1, u128 t2, u128 t3, u128 t4) {
+    t1 += (uint64_t)(t0 >> 51);
+    t2 += (uint64_t)(t1 >> 51);
+    t3 += (uint64_t)(t2 >> 51);
+    t4 += (uint64_t)(t3 >> 51);
+    u128 r0 = ((uint64_t)t0 & LIMB_MASK) + (u128)(uint64_t)(t4 >> 51) * 19;
+    out[0] = (uint64_t)r0 & LIMB_MASK;
+    out[1] = ((uint64_t)t1 & LIMB_MASK) + (uint64_t)(r0 >> 51);
+    out[2] = (uint64_t)t2 & LIMB_MASK;
+    out[3] = (uint64_t)t3 & LIMB_MASK;
+    out[4] = (uint64_t)t4 & LIMB_MASK;
+}
+
+static inline void feMul(FieldElement out, const FieldElement a, const FieldElement b) {
+    uint64_t b1 = b[1] * 19, b2 = b[2] * 19, b3 = b[3] * 19, b4 = b[4] * 19;
+    u128 t0 = (u128)a[0] * b[0] + (u128)a[1] * b4 + (u128)a[2] * b3 + (u128)a[3] * b2 + (u128)a[4] * b1;
+    u128 t1 = (u128)a[0] * b[1] + (u128)a[1] * b[0] + (u128)a[2] * b4 + (u128)a[3] * b3 + (u128)a[4] * b2;
+    u128 t2 = (u128)a[0] * b[2] + (u128)a[1] * b[1] + (u128)a[2] * b[0] + (u128)a[3] * b4 + (u128)a[4] * b3;
+    u128 t3 = (u128)a[0] * b[3] + (u128)a[1] * b[2] + (u128)a[2] * b[1] + (u128)a[3] * b[0] + (u128)a[4] * b4;
+    u128 t4 = (u128)a[0] * b[4] + (u128)a[1] * b[3] + (u128)a[2] * b[2] + (u128)a[3] * b[1] + (u128)a[4] * b[0];
+    feCarry(out, t0, t1, t2, t3, t4);
+}
 
-// Modular inverse: (n * x) % P = 1
-ll modInverse(ll n) {
-    n = (n % P + P) % P; // Ensure n is positive
-    for (ll x = 1; x < P; x++)
-        if ((n * x) % P == 1)
-            return x;
-    return 1;
+// a^2, sharing the symmetric cross products
+static inline void feSqr(FieldElement out, const FieldElement a) {
+    uint64_t a0_2 = a[0] * 2, a1_2 = a[1] * 2;
+    uint64_t a3_19 = a[3] * 19, a4_19 = a[4] * 19;
+    u128 t0 = (u128)a[0] * a[0] + (u128)(a[1] * 2) * a4_19 + (u128)(a[2] * 2) * a3_19;
+    u128 t1 = (u128)a0_2 * a[1] + (u128)(a[2] * 2) * a4_19 + (u128)a[3] * a3_19;
+    u128 t2 = (u128)a0_2 * a[2] + (u128)a[1] * a[1] + (u128)(a[3] * 2) * a4_19;
+    u128 t3 = (u128)a0_2 * a[3] + (u128)a1_2 * a[2] + (u128)a[4] * a4_19;
+    u128 t4 = (u128)a0_2 * a[4] + (u128)a1_2 * a[3] + (u128)a[2] * a[2];
+    feCarry(out, t0, t1, t2, t3, t4);
 }
 
-// Add two points on the curve
-Point point_add(Point p1, Point p2) {
-    ll m;
-    if (p1.x == p2.x && p1.y == p2.y) { // Point doubling
-        ll numerator = (3 * p1.x * p1.x + A);
-        ll denominator = (2 * p1.y);
-        m = (numerator * modInverse(denominator));
-    } else { // Point addition
-        ll numerator = (p2.y - p1.y);
-        ll denominator = (p2.x - p1.x);
-        m = (numerator * modInverse(denominator));
+// a^(2^n)
+static inline void feSqrN(FieldElement out, const FieldElement a, int n) {
+    feSqr(out, a);
+    for (int i = 1; i < n; i++) feSqr(out, out);
+}
+
+// a * 121665, the ladder constant (A - 2) / 4 for A = 486662
+static inline void feMul121665(FieldElement out, const FieldElement a) {
+    feCarry(out, (u128)a[0] * 121665, (u128)a[1] * 121665, (u128)a[2] * 121665,
+            (u128)a[3] * 121665, (u128)a[4] * 121665);
+}
+
+// a^(p - 2) = a^-1 by Fermat, along the fixed 254-squaring addition chain
+static void feInvert(FieldElement out, const FieldElement a) {
+    FieldElement z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+    feSqr(z2, a);
+    feSqrN(t, z2, 2);
+    feMul(z9, t, a);
+    feMul(z11, z9, z2);
+    feSqr(t, z11);
+    feMul(z2_5_0, t, z9);
+    feSqrN(t, z2_5_0, 5);
+    feMul(z2_10_0, t, z2_5_0);
+    feSqrN(t, z2_10_0, 10);
+    feMul(z2_20_0, t, z2_10_0);
+    feSqrN(t, z2_20_0, 20);
+    feMul(t, t, z2_20_0);
+    feSqrN(t, t, 10);
+    feMul(z2_50_0, t, z2_10_0);
+    feSqrN(t, z2_50_0, 50);
+    feMul(z2_100_0, t, z2_50_0);
+    feSqrN(t, z2_100_0, 100);
+    feMul(t, t, z2_100_0);
+    feSqrN(t, t, 50);
+    feMul(t, t, z2_50_0);
+    feSqrN(t, t, 5);
+    feMul(out, t, z11);
+}
+
+// Swap a and b when swap is 1, with no branch on it
+static inline void feCswap(FieldElement a, FieldElement b, uint64_t swap) {
+    uint64_t mask = 0 - swap;
+    for (int i = 0; i < 5; i++) {
+        uint64_t x = mask & (a[i] ^ b[i]);
+        a[i] ^= x;
+        b[i] ^= x;
     }
-    
-    // Perform all calculations with the modulus
-    m = (m % P + P) % P;
-    ll x3 = (m * m - p1.x - p2.x);
-    x3 = (x3 % P + P) % P;
-    ll y3 = (m * (p1.x - x3) - p1.y);
-    y3 = (y3 % P + P) % P;
-    return {x3, y3};
 }
 
-// Scalar multiplication: k * P (double-and-add algorithm)
-Point scalar_mult(ll k, Point p) {
-    Point res = {0, 0}; // Point at infinity
-    Point addend = p;
-    while (k > 0) {
-        if (k & 1) { // If k is odd
-             if (res.x == 0 && res.y == 0) res = addend;
-             else res = point_add(res, addend);
+// Little-endian u-coordinate; the top bit is ignored as RFC 7748 requires
+static void feFromBytes(FieldElement out, const uint8_t* s) {
+    uint64_t w[4];
+    for (int i = 0; i < 4; i++) {
+        w[i] = 0;
+        for (int j = 7; j >= 0; j--) w[i] = (w[i] << 8) | s[8 * i + j];
+    }
+    out[0] = w[0] & LIMB_MASK;
+    out[1] = ((w[0] >> 51) | (w[1] << 13)) & LIMB_MASK;
+    out[2] = ((w[1] >> 38) | (w[2] << 26)) & LIMB_MASK;
+    out[3] = ((w[2] >> 25) | (w[3] << 39)) & LIMB_MASK;
+    out[4] = (w[3] >> 12) & LIMB_MASK;
+}
+
+// The canonical (fully reduced) little-endian encoding of a
+static void feToBytes(uint8_t* s, const FieldElement a) {
+    FieldElement h;
+    feCopy(h, a);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 4; i++) {
+            h[i + 1] += h[i] >> 51;
+            h[i] &= LIMB_MASK;
         }
-        addend = point_add(addend, addend);
-        k >>= 1; // k = k / 2
+        h[0] += 19 * (h[4] >> 51);
+        h[4] &= LIMB_MASK;
+    }
+    // h < 2^255 now; subtract p when h >= p, i.e. when h + 19 carries out
+    uint64_t q = (h[0] + 19) >> 51;
+    for (int i = 1; i < 5; i++) q = (h[i] + q) >> 51;
+    h[0] += 19 * q;
+    for (int i = 0; i < 4; i++) {
+        h[i + 1] += h[i] >> 51;
+        h[i] &= LIMB_MASK;
+    }
+    h[4] &= LIMB_MASK;
+
+    uint64_t w[4] = {
+        h[0] | (h[1] << 51),
+        (h[1] >> 13) | (h[2] << 38),
+        (h[2] >> 26) | (h[3] << 25),
+        (h[3] >> 39) | (h[4] << 12)
+    };
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 8; j++) s[8 * i + j] = (uint8_t)(w[i] >> (8 * j));
     }
-    return res;
 }
 
+// out = scalar * u by the Montgomery ladder of RFC 7748 section 5: the same
+// 255 steps and conditional swaps for every scalar
+static void x25519ScalarMult(uint8_t* out, const uint8_t* scalar, const uint8_t* u) {
+    uint8_t k[32];
+    memcpy(k, scalar, 32);
+    k[0] &= 248;
+    k[31] &= 127;
+    k[31] |= 64;
+
+    FieldElement x1, x2 = {1}, z2 = {0}, x3, z3 = {1};
+    FieldElement a, aa, b, bb, e, c, d, da, cb;
+    feFromBytes(x1, u);
+    feCopy(x3, x1);
+    uint64_t swap = 0;
+    for (int t = 254; t >= 0; t--) {
+        uint64_t bit = (k[t >> 3] >> (t & 7)) & 1;
+        swap ^= bit;
+        feCswap(x2, x3, swap);
+        feCswap(z2, z3, swap);
+        swap = bit;
+
+        feAdd(a, x2, z2);
+        feSqr(aa, a);
+        feSub(b, x2, z2);
+        feSqr(bb, b);
+        feSub(e, aa, bb);
+        feAdd(c, x3, z3);
+        feSub(d, x3, z3);
+        feMul(da, d, a);
+        feMul(cb, c, b);
+        feAdd(x3, da, cb);
+        feSqr(x3, x3);
+        feSub(z3, da, cb);
+        feSqr(z3, z3);
+        feMul(z3, z3, x1);
+        feMul(x2, aa, bb);
+        feMul121665(z2, e);
+        feAdd(z2, z2, aa);
+        feMul(z2, z2, e);
+    }
+    feCswap(x2, x3, swap);
+    feCswap(z2, z3, swap);
+
+    feInvert(z2, z2);
+    feMul(x2, x2, z2);
+    feToBytes(out, x2);
+    memset(k, 0, sizeof(k));
+}
+
+static const uint8_t X25519_BASE_POINT[32] = {9};
+
 extern "C" {
+    // Returns "private,public_x,public_y"
     EMSCRIPTEN_KEEPALIVE const char* generate_ecc_keys() {
         srand(time(NULL));
-        Point G = {2, 5};
         ll private_key = (rand() % 200) + 50;
-        Point public_key = scalar_mult(private_key, G);
+        Point public_key = generatorMult(private_key);
         std::string result = std::to_string(private_key) + "," + std::to_string(public_key.x) + "," + std::to_string(public_key.y);
-        char* c_str = (char*)malloc(result.length() + 1);
-        strncpy(c_str, result.c_str(), result.length());
-        c_str[result.length()] = '\0';
-        return c_str;
+        return toCString(result);
     }
 
+    // The x coordinate of private_key * their public key, or 0 if that key
+    // is not on the curve or the product is the point at infinity
     EMSCRIPTEN_KEEPALIVE const char* calculate_shared_secret(ll private_key, ll their_pub_x, ll their_pub_y) {
-        Point their_pub_key = {their_pub_x, their_pub_y};
-        Point shared_secret_point = scalar_mult(private_key, their_pub_key);
-        std::string result = std::to_string(shared_secret_point.x);
-        char* c_str = (char*)malloc(result.length() + 1);
-        strncpy(c_str, result.c_str(), result.length());
-        c_str[result.length()] = '\0';
-        return c_str;
+        Point their_pub_key = {their_pub_x, their_pub_y, false};
+        if (!onCurve(their_pub_key)) {
+            return 0; // Error: not a curve point
+        }
+        Point shared_secret_point = scalarMult(private_key, their_pub_key);
+        if (shared_secret_point.infinity) {
+            return 0; // Error: no shared point
+        }
+        return toCString(std::to_string(shared_secret_point.x));
+    }
+
+    // X25519 public key for a 32-byte private key: private_key * 9
+    EMSCRIPTEN_KEEPALIVE int x25519_public_key(uint8_t* public_key, const uint8_t* private_key) {
+        if (!public_key || !private_key) {
+            return 0; // Error: missing buffer
+        }
+        x25519ScalarMult(public_key, private_key, X25519_BASE_POINT);
+        return 1; // Success
+    }
+
+    // A random 32-byte private key and its public key
+    EMSCRIPTEN_KEEPALIVE int x25519_generate_keys(uint8_t* private_key, uint8_t* public_key) {
+        if (!private_key || !public_key) {
+            return 0; // Error: missing buffer
+        }
+        if (getentropy(private_key, 32) != 0) {
+            return 0; // Error: no system randomness
+        }
+        x25519ScalarMult(public_key, private_key, X25519_BASE_POINT);
+        return 1; // Success
     }
-}
\ No newline at end of file
+
+    // The 32-byte shared secret private_key * their_public_key. Returns 0
+    // when it is all zero, which a small-order peer key forces (RFC 7748
+    // section 6.1).
+    EMSCRIPTEN_KEEPALIVE int x25519_shared_secret(uint8_t* shared_secret, const uint8_t* private_key, const uint8_t* their_public_key) {
+        if (!shared_secret || !private_key || !their_public_key) {
+            return 0; // Error: missing buffer
+        }
+        x25519ScalarMult(shared_secret, private_key, their_public_key);
+        uint8_t any = 0;
+        for (int i = 0; i < 32; i++) any |= shared_secret[i];
+        if (any == 0) {
+            return 0; // Error: small-order public key
+        }
+        return 1; // Success
+    }
+}
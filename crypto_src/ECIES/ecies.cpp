@@ -2,53 +2,15 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
-
-// --- ECC Math (copied from ecc.cpp for simplicity) ---
-typedef long long int ll;
-const ll P = 3851;
-const ll A = 0;
-struct Point { ll x, y; };
-ll modInverse(ll n) {
-    n = (n % P + P) % P; // Ensure n is positive
-    for (ll x = 1; x < P; x++)
-        if ((n * x) % P == 1)
-            return x;
-    return 1;
-}
-Point point_add(Point p1, Point p2) {
-    ll m;
-    if (p1.x == p2.x && p1.y == p2.y) { // Point doubling
-        ll numerator = (3 * p1.x * p1.x + A);
-        ll denominator = (2 * p1.y);
-        m = (numerator * modInverse(denominator));
-    } else { // Point addition
-        ll numerator = (p2.y - p1.y);
-        ll denominator = (p2.x - p1.x);
-        m = (numerator * modInverse(denominator));
-    }
-    
-    // Perform all calculations with the modulus
-    m = (m % P + P) % P;
-    ll x3 = (m * m - p1.x - p2.x);
-    x3 = (x3 % P + P) % P;
-    ll y3 = (m * (p1.x - x3) - p1.y);
-    y3 = (y3 % P + P) % P;
-    return {x3, y3};
-}
-Point scalar_mult(ll k, Point p) {
-    Point res = {0, 0}; // Point at infinity
-    Point addend = p;
-    while (k > 0) {
-        if (k & 1) { // If k is odd
-             if (res.x == 0 && res.y == 0) res = addend;
-             else res = point_add(res, addend);
-        }
-        addend = point_add(addend, addend);
-        k >>= 1; // k = k / 2
-    }
-    return res;
-}
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#include "../Common/ec_curve.h"
 
 // --- AES Logic (copied from aes.cpp for simplicity) ---
 void placeholder_aes_process_block(const uint8_t* input, const uint8_t* key, uint8_t* output) {
@@ -76,12 +38,17 @@ std::vector<uint8_t> process_aes_ecb(const std::vector<uint8_t>& data, const std
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     const char* encrypt_ecies(const char* plaintext, ll pub_x, ll pub_y) {
-        Point recipient_pub_key = {pub_x, pub_y};
-        Point G = {2, 5};
+        Point recipient_pub_key = {pub_x, pub_y, false};
+        if (!onCurve(recipient_pub_key)) {
+            return 0; // Error: not a curve point
+        }
         srand(time(NULL));
         ll ephemeral_priv_key = (rand() % 200) + 50;
-        Point ephemeral_pub_key = scalar_mult(ephemeral_priv_key, G);
-        Point shared_point = scalar_mult(ephemeral_priv_key, recipient_pub_key);
+        Point ephemeral_pub_key = generatorMult(ephemeral_priv_key);
+        Point shared_point = scalarMult(ephemeral_priv_key, recipient_pub_key);
+        if (shared_point.infinity) {
+            return 0; // Error: no shared point
+        }
         ll shared_secret_x = shared_point.x;
         std::vector<uint8_t> aes_key;
         for(int i = 0; i < 16; ++i) aes_key.push_back((shared_secret_x >> (i % 8)) & 0xFF);
@@ -116,10 +83,16 @@ extern "C" {
         while(ss >> byte_val) {
             ciphertext_bytes.push_back(byte_val);
         }
-        Point ephemeral_pub_key = {R_x, R_y};
+        Point ephemeral_pub_key = {R_x, R_y, false};
+        if (!onCurve(ephemeral_pub_key)) {
+            return 0; // Error: not a curve point
+        }
 
         // 2. Derive shared secret
-        Point shared_point = scalar_mult(private_key, ephemeral_pub_key);
+        Point shared_point = scalarMult(private_key, ephemeral_pub_key);
+        if (shared_point.infinity) {
+            return 0; // Error: no shared point
+        }
         ll shared_secret_x = shared_point.x;
 
         // 3. Use shared secret to derive the same AES key
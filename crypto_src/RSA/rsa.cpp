@@ -1,42 +1,132 @@
 // crypto_src/RSA/rsa.cpp
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <vector>
-#include <numeric>
-#include <cstdlib> // For rand()
+#include <sys/random.h>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
-#include<time.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#include "../Common/bigint.h"
+#include "../Common/sha256.h"
+#include "../Common/thread_pool.h"
 
-// Type for large integers
-typedef long long int ll;
+// Public exponent for generated keys
+#define RSA_PUBLIC_EXPONENT 65537
+// Odd primes below this sieve prime candidates before any exponentiation
+#define PRIME_SIEVE_LIMIT 4096
+// Consecutive odd candidates covered by one sieve pass
+#define PRIME_SIEVE_WINDOW 4096
 
-// Modular exponentiation: (base^exp) % mod
-ll power(ll base, ll exp, ll mod) {
-    ll res = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp % 2 == 1) res = (res * base) % mod;
-        base = (base * base) % mod;
-        exp /= 2;
+// Padding schemes for rsa_encrypt() and rsa_decrypt()
+#define RSA_PADDING_PKCS1 1 // PKCS#1 v1.5 encryption padding (block type 2)
+#define RSA_PADDING_OAEP 2  // OAEP with SHA-256, MGF1-SHA-256 and an empty label
+
+constexpr int countOddPrimes(int limit) {
+    int count = 0;
+    for (int n = 3; n < limit; n += 2) {
+        bool prime = true;
+        for (int d = 3; d * d <= n; d += 2) {
+            if (n % d == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (prime) count++;
     }
-    return res;
+    return count;
 }
 
-// Miller-Rabin primality test (for key generation)
-bool is_prime(ll n, int k = 5) {
-    if (n <= 1 || n == 4) return false;
-    if (n <= 3) return true;
-    ll d = n - 1;
-    while (d % 2 == 0) d /= 2;
-    for (int i = 0; i < k; i++) {
-        ll a = 2 + rand() % (n - 4);
-        ll x = power(a, d, n);
-        if (x == 1 || x == n - 1) continue;
+static constexpr int smallPrimeCount = countOddPrimes(PRIME_SIEVE_LIMIT);
+
+struct SmallPrimes {
+    uint16_t p[smallPrimeCount];
+};
+
+// The odd primes below PRIME_SIEVE_LIMIT, by the sieve of Eratosthenes
+constexpr SmallPrimes makeSmallPrimes() {
+    SmallPrimes t = {};
+    bool composite[PRIME_SIEVE_LIMIT] = {};
+    int count = 0;
+    for (int n = 3; n < PRIME_SIEVE_LIMIT; n += 2) {
+        if (composite[n]) continue;
+        t.p[count++] = (uint16_t)n;
+        for (int m = n * n; m < PRIME_SIEVE_LIMIT; m += 2 * n) composite[m] = true;
+    }
+    return t;
+}
+
+static constexpr SmallPrimes smallPrimes = makeSmallPrimes();
+
+// Fill buf with len bytes from the system random source.
+// Returns false if the source fails.
+static bool randomBytes(uint8_t* buf, int len) {
+    while (len > 0) {
+        int n = (len < 256) ? len : 256;
+        if (getentropy(buf, n) != 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Random integer below 2^bits
+static bool randomBits(BigInt& out, int bits) {
+    uint8_t buf[BIGINT_MAX_BITS / 8];
+    int len = (bits + 7) / 8;
+    if (!randomBytes(buf, len)) return false;
+    if (bits % 8) buf[0] &= (uint8_t)((1 << (bits % 8)) - 1);
+    return bigFromBytes(buf, len, out);
+}
+
+// Miller-Rabin rounds for a random candidate of `bits` bits, for an error
+// probability below 2^-80 (HAC table 4.4)
+static int millerRabinRounds(int bits) {
+    return (bits >= 1300) ? 2 : (bits >= 850) ? 3 : (bits >= 650) ? 4 : (bits >= 550) ? 5 :
+           (bits >= 450) ? 6 : (bits >= 400) ? 7 : (bits >= 350) ? 8 : (bits >= 300) ? 9 :
+           (bits >= 250) ? 12 : (bits >= 200) ? 15 : (bits >= 150) ? 18 : 27;
+}
+
+// Miller-Rabin test of an odd n > 3 with `rounds` random bases
+static bool millerRabin(const BigInt& n, int rounds) {
+    // n - 1 = d * 2^s
+    BigInt nMinus1 = n;
+    BigInt d;
+    bigSubSmall(nMinus1, 1);
+    int s = 0;
+    while (!bigTestBit(nMinus1, s)) s++;
+    bigShiftRight(nMinus1, s, d);
+
+    MontContext ctx;
+    montSetup(ctx, n);
+    int k = ctx.k;
+    uint32_t minusOne[MONT_LIMBS];
+    limbSub(minusOne, ctx.n, ctx.one, k);
+
+    BigInt range = n;
+    bigSubSmall(range, 3);
+    for (int i = 0; i < rounds; i++) {
+        // Base a in [2, n - 2]
+        BigInt a;
+        if (!randomBits(a, bigBitLength(n))) return false;
+        bigMod(a, range, a);
+        bigMulAddSmall(a, 1, 2);
+
+        uint32_t x[MONT_LIMBS];
+        montToDomain(ctx, a, x);
+        montPower(ctx, x, d, x);
+        if (memcmp(x, ctx.one, 4 * k) == 0 || memcmp(x, minusOne, 4 * k) == 0) continue;
         bool prime = false;
-        while (d != n - 1) {
-            x = (x * x) % n;
-            d *= 2;
-            if (x == 1) return false;
-            if (x == n - 1) {
+        for (int j = 1; j < s; j++) {
+            montSqr(ctx, x, x);
+            if (memcmp(x, ctx.one, 4 * k) == 0) return false;
+            if (memcmp(x, minusOne, 4 * k) == 0) {
                 prime = true;
                 break;
             }
@@ -46,69 +136,984 @@ bool is_prime(ll n, int k = 5) {
     return true;
 }
 
-// Modular inverse: (a * x) % m = 1
-ll modInverse(ll a, ll m) {
-    for (ll x = 1; x < m; x++)
-        if (((a % m) * (x % m)) % m == 1)
-            return x;
+// Primality test: trial division by the small primes, which settles
+// anything below PRIME_SIEVE_LIMIT^2, then Miller-Rabin
+bool is_prime(const BigInt& n) {
+    if (bigBitLength(n) <= 1) return false;
+    if (n.size == 1 && n.limb[0] <= 3) return true;
+    if (!bigIsOdd(n)) return false;
+    for (uint16_t p : smallPrimes.p) {
+        if (n.size == 1 && n.limb[0] == p) return true;
+        if (bigModSmall(n, p) == 0) return false;
+    }
+    if (n.size == 1 && (uint64_t)n.limb[0] < (uint64_t)PRIME_SIEVE_LIMIT * PRIME_SIEVE_LIMIT) return true;
+    return millerRabin(n, millerRabinRounds(bigBitLength(n)));
+}
+
+// A random prime of exactly `bits` bits (16 or more) with its top two bits
+// set, so the product of two such primes has full width. p mod e != 1
+// keeps e invertible mod p - 1.
+//
+// From a random odd start x, the candidates x, x + 2, x + 4, ... are
+// sieved a window at a time: x mod q for each small prime q gives the
+// offsets q divides, so most composites are struck out without touching a
+// big number. The survivors are Miller-Rabin tested in parallel; the
+// lowest prime offset wins, so the result matches a serial scan.
+static bool randomPrime(BigInt& p, int bits, uint32_t e) {
+    int rounds = millerRabinRounds(bits);
+    for (;;) {
+        BigInt x;
+        if (!randomBits(x, bits)) return false;
+        for (int i = x.size; i < (bits + 31) / 32; i++) x.limb[i] = 0;
+        x.limb[(bits - 1) / 32] |= 1u << ((bits - 1) % 32);
+        x.limb[(bits - 2) / 32] |= 1u << ((bits - 2) % 32);
+        x.limb[0] |= 1;
+        x.size = (bits + 31) / 32;
+
+        uint16_t residues[smallPrimeCount];
+        for (int j = 0; j < smallPrimeCount; j++) {
+            residues[j] = (uint16_t)bigModSmall(x, smallPrimes.p[j]);
+        }
+        uint32_t residueE = bigModSmall(x, e);
+
+        uint8_t composite[PRIME_SIEVE_WINDOW];
+        uint16_t survivors[PRIME_SIEVE_WINDOW];
+        for (uint32_t base = 0; base + PRIME_SIEVE_WINDOW <= 0x10000; base += PRIME_SIEVE_WINDOW) {
+            // Candidate i of this window is x + 2 * (base + i)
+            for (int i = 0; i < PRIME_SIEVE_WINDOW; i++) composite[i] = 0;
+            for (int j = 0; j < smallPrimeCount; j++) {
+                uint32_t q = smallPrimes.p[j];
+                uint32_t r = (residues[j] + 2 * base) % q;
+                // First i with r + 2i = 0 (mod q); (q + 1) / 2 is 1/2 mod q
+                uint32_t i = (q - r) % q * ((q + 1) / 2) % q;
+                for (; i < PRIME_SIEVE_WINDOW; i += q) composite[i] = 1;
+            }
+            uint32_t re = (residueE + 2 * base) % e;
+            int count = 0;
+            for (int i = 0; i < PRIME_SIEVE_WINDOW; i++) {
+                if (!composite[i] && (re + 2 * i) % e != 1) survivors[count++] = (uint16_t)i;
+            }
+
+            std::atomic<int> best(count);
+            parallelFor(count, [&](int j) {
+                if (j >= best.load()) return;
+                BigInt c = x;
+                bigMulAddSmall(c, 1, 2 * (base + survivors[j]));
+                if (bigBitLength(c) != bits || !millerRabin(c, rounds)) return;
+                int cur = best.load();
+                while (j < cur && !best.compare_exchange_weak(cur, j)) {}
+            });
+            if (best.load() < count) {
+                p = x;
+                bigMulAddSmall(p, 1, 2 * (base + survivors[best.load()]));
+                return true;
+            }
+        }
+    }
+}
+
+// A private key. With crt set, decryption uses the CRT components instead
+// of d: two half-size exponentiations recombined by Garner's formula.
+struct RsaPrivateKey {
+    BigInt n, d;
+    MontContext montN;
+    bool crt;
+    BigInt p, q, dP, dQ, qInv;
+    MontContext montP, montQ;
+    uint32_t qInvMont[MONT_LIMBS]; // qInv in Montgomery form mod p
+};
+
+// Parse a private key given as "d" or "d,p,q,dP,dQ,qInv" (p > q, decimal).
+// Returns false if it is malformed, n is even or p * q != n.
+static bool parsePrivateKey(const BigInt& n, const char* key_str, RsaPrivateKey& key) {
+    std::string parts[6];
+    int count = 1;
+    for (const char* c = key_str; *c; c++) {
+        if (*c == ',') {
+            if (count == 6) return false;
+            count++;
+        } else {
+            parts[count - 1] += *c;
+        }
+    }
+    if (count != 1 && count != 6) return false;
+    key.n = n;
+    key.crt = (count == 6);
+    if (!bigFromString(parts[0].c_str(), key.d) || !montSetup(key.montN, n)) return false;
+    if (!key.crt) return true;
+
+    BigInt* fields[5] = {&key.p, &key.q, &key.dP, &key.dQ, &key.qInv};
+    for (int i = 0; i < 5; i++) {
+        if (!bigFromString(parts[i + 1].c_str(), *fields[i])) return false;
+    }
+    BigInt pq;
+    if (!bigMul(key.p, key.q, pq) || bigCompare(pq, n) != 0 || bigCompare(key.p, key.q) <= 0) return false;
+    if (!montSetup(key.montP, key.p) || !montSetup(key.montQ, key.q)) return false;
+    montToDomain(key.montP, key.qInv, key.qInvMont);
+    return true;
+}
+
+// m = c^d mod n, by CRT when the key has the components:
+// m1 = c^dP mod p, m2 = c^dQ mod q, m = m2 + q * (qInv * (m1 - m2) mod p)
+static void rsaPrivate(const RsaPrivateKey& key, const BigInt& c, BigInt& m) {
+    uint32_t x[MONT_LIMBS];
+    if (!key.crt) {
+        montToDomain(key.montN, c, x);
+        montPowerConstTime(key.montN, x, key.d, x);
+        montFromDomain(key.montN, x, m);
+        return;
+    }
+    BigInt m1, m2, t, h;
+    montToDomain(key.montP, c, x);
+    montPowerConstTime(key.montP, x, key.dP, x);
+    montFromDomain(key.montP, x, m1);
+    montToDomain(key.montQ, c, x);
+    montPowerConstTime(key.montQ, x, key.dQ, x);
+    montFromDomain(key.montQ, x, m2);
+
+    // h = qInv * (m1 - m2) mod p; m2 < q < p, so one conditional add of p
+    // keeps the difference non-negative. With qInv held as qInv * R, one
+    // Montgomery product yields h in ordinary form without a division.
+    if (bigCompare(m1, m2) < 0) bigAdd(m1, key.p, m1);
+    bigSub(m1, m2, t);
+    int kp = key.montP.k;
+    for (int i = t.size; i < kp; i++) t.limb[i] = 0;
+    montMul(key.montP, t.limb, key.qInvMont, h.limb);
+    h.size = kp;
+    bigTrim(h);
+    bigMul(h, key.q, t);
+    bigAdd(t, m2, m);
+}
+
+// --- Block padding ---
+//
+// Binary messages are cut into pieces that fit one k-byte block (k the
+// byte length of n) after padding, so a message costs one exponentiation
+// per block instead of one per byte.
+
+// Largest message piece one k-byte block carries, or 0 if k is too small
+// for the padding (or the padding is unknown)
+static int rsaBlockCapacity(int k, int padding) {
+    int overhead = (padding == RSA_PADDING_PKCS1) ? 11 : (padding == RSA_PADDING_OAEP) ? 2 * SHA256_DIGEST_SIZE + 2 : k;
+    return (k > overhead) ? k - overhead : 0;
+}
+
+// Byte masks: all ones if the condition holds, else zero
+static inline uint32_t ctIsZero(uint32_t x) {
+    return 0 - (((x - 1) >> 31) & (~x >> 31));
+}
+
+static inline uint32_t ctEqual(uint32_t a, uint32_t b) {
+    return ctIsZero(a ^ b);
+}
+
+// EM = 00 || 02 || PS || 00 || M with PS at least 8 random non-zero bytes
+static bool pkcs1Pad(const uint8_t* m, int mLen, uint8_t* em, int k) {
+    int psLen = k - 3 - mLen;
+    em[0] = 0;
+    em[1] = 2;
+    if (!randomBytes(em + 2, psLen)) return false;
+    for (int i = 2; i < 2 + psLen; i++) {
+        while (em[i] == 0) {
+            if (!randomBytes(em + i, 1)) return false;
+        }
+    }
+    em[2 + psLen] = 0;
+    if (mLen > 0) memcpy(em + 3 + psLen, m, mLen);
+    return true;
+}
+
+// Length of the message in a PKCS#1 v1.5 block, copied to m, or -1 if the
+// block is malformed. The scan does not branch on the block contents.
+static int pkcs1Unpad(const uint8_t* em, int k, uint8_t* m) {
+    uint32_t good = ctIsZero(em[0]) & ctEqual(em[1], 2);
+    uint32_t looking = ~0u;
+    uint32_t zeroIndex = 0;
+    for (int i = 2; i < k; i++) {
+        uint32_t isZero = ctIsZero(em[i]);
+        zeroIndex |= looking & isZero & (uint32_t)i;
+        looking &= ~isZero;
+    }
+    // A separator must exist and follow at least 8 padding bytes
+    good &= ~looking & ~(0 - ((zeroIndex - 10) >> 31));
+    if (!good) return -1;
+    int mLen = k - 1 - (int)zeroIndex;
+    memcpy(m, em + zeroIndex + 1, mLen);
+    return mLen;
+}
+
+// EM = 00 || maskedSeed || maskedDB with DB = lHash || PS || 01 || M
+// (PKCS#1 v2.2, RFC 8017 section 7.1.1)
+static bool oaepPad(const uint8_t* m, int mLen, uint8_t* em, int k) {
+    const int h = SHA256_DIGEST_SIZE;
+    uint8_t* seed = em + 1;
+    uint8_t* db = em + 1 + h;
+    int dbLen = k - h - 1;
+    em[0] = 0;
+    sha256(0, 0, db);
+    memset(db + h, 0, dbLen - h - mLen - 1);
+    db[dbLen - mLen - 1] = 1;
+    if (mLen > 0) memcpy(db + dbLen - mLen, m, mLen);
+    if (!randomBytes(seed, h)) return false;
+    mgf1XorSha256(seed, h, db, dbLen);
+    mgf1XorSha256(db, dbLen, seed, h);
+    return true;
+}
+
+// Length of the message in an OAEP block, copied to m, or -1 if the block
+// is malformed. em is unmasked in place. Every check is folded into one
+// mask before the single branch, so a bad block looks the same whichever
+// check failed.
+static int oaepUnpad(uint8_t* em, int k, uint8_t* m) {
+    const int h = SHA256_DIGEST_SIZE;
+    uint8_t* seed = em + 1;
+    uint8_t* db = em + 1 + h;
+    int dbLen = k - h - 1;
+    mgf1XorSha256(db, dbLen, seed, h);
+    mgf1XorSha256(seed, h, db, dbLen);
+
+    uint8_t lHash[SHA256_DIGEST_SIZE];
+    sha256(0, 0, lHash);
+    uint32_t good = ctIsZero(em[0]);
+    for (int i = 0; i < h; i++) good &= ctEqual(db[i], lHash[i]);
+
+    // PS is zero bytes up to the first 01
+    uint32_t looking = ~0u;
+    uint32_t oneIndex = 0;
+    for (int i = h; i < dbLen; i++) {
+        uint32_t isOne = ctEqual(db[i], 1);
+        uint32_t isZero = ctIsZero(db[i]);
+        oneIndex |= looking & isOne & (uint32_t)i;
+        good &= ~looking | isOne | isZero;
+        looking &= ~isOne;
+    }
+    good &= ~looking;
+    if (!good) return -1;
+    int mLen = dbLen - 1 - (int)oneIndex;
+    memcpy(m, db + oneIndex + 1, mLen);
+    return mLen;
+}
+
+// A parsed key with its Montgomery constants, set up once by
+// rsa_create_key() and shared read-only by every message processed with it
+struct RsaKey {
+    BigInt n, e;
+    int k;             // bytes in n
+    MontContext montN;
+    bool hasPublic, hasPrivate;
+    RsaPrivateKey priv;
+};
+
+// Bytes rsaEncryptMessage() writes for len message bytes, or -1 if the
+// modulus is too small for the padding or the result would overflow
+static int rsaEncryptedSize(int k, int len, int padding) {
+    int capacity = rsaBlockCapacity(k, padding);
+    if (capacity == 0 || len < 0) return -1;
+    int64_t blocks = (len == 0) ? 1 : (len + (int64_t)capacity - 1) / capacity;
+    return (blocks * k > 0x7fffffff) ? -1 : (int)(blocks * k);
+}
+
+// Pad and encrypt one message into rsaEncryptedSize() bytes of out.
+// Returns the bytes written, or -1 if the random source fails.
+static int rsaEncryptMessage(const RsaKey& key, const uint8_t* data, int len, int padding, uint8_t* out) {
+    int k = key.k;
+    int capacity = rsaBlockCapacity(k, padding);
+    int total = rsaEncryptedSize(k, len, padding);
+    uint8_t em[BIGINT_MAX_BITS / 8];
+    uint32_t x[MONT_LIMBS];
+    BigInt m;
+    for (int off = 0, pos = 0; pos < total; off += capacity, pos += k) {
+        int n = (len - off < capacity) ? len - off : capacity;
+        bool padded = (padding == RSA_PADDING_OAEP) ? oaepPad(data + off, n, em, k) : pkcs1Pad(data + off, n, em, k);
+        if (!padded) return -1;
+        bigFromBytes(em, k, m);
+        montToDomain(key.montN, m, x);
+        montPower(key.montN, x, key.e, x);
+        montFromDomain(key.montN, x, m);
+        bigToBytes(m, out + pos, k);
+    }
+    return total;
+}
+
+// Decrypt and unpad one message of whole k-byte blocks into out, which
+// needs len bytes. Returns the message length, or -1 for a partial block,
+// a block not below n or bad padding.
+static int rsaDecryptMessage(const RsaKey& key, const uint8_t* data, int len, int padding, uint8_t* out) {
+    int k = key.k;
+    if (len <= 0 || len % k != 0) return -1;
+    uint8_t em[BIGINT_MAX_BITS / 8];
+    BigInt c, m;
+    int written = 0;
+    for (int pos = 0; pos < len; pos += k) {
+        bigFromBytes(data + pos, k, c);
+        if (bigCompare(c, key.n) >= 0) return -1;
+        rsaPrivate(key.priv, c, m);
+        bigToBytes(m, em, k);
+        int n = (padding == RSA_PADDING_OAEP) ? oaepUnpad(em, k, out + written) : pkcs1Unpad(em, k, out + written);
+        if (n < 0) return -1;
+        written += n;
+    }
+    return written;
+}
+
+// --- Factoring ---
+//
+// The rsa_factor_*() exports split a modulus, to show how fast small keys
+// fall. Trial division by the sieve primes comes first, then Pollard's rho
+// with Brent's cycle detection, which needs about sqrt(p) steps for the
+// smallest prime factor p, then stage 1 of Lenstra's elliptic curve method
+// (ECM), whose cost grows far more slowly with p. Each rho run and each
+// curve is independent, so a round hands one to every thread.
+
+// Widest modulus rsa_factor_create() accepts
+#define FACTOR_MAX_BITS 256
+// Rho runs before ECM takes over, and the step limit of each
+#define FACTOR_RHO_RUNS 2
+#define FACTOR_RHO_STEPS (1 << 18)
+// Differences multiplied together per gcd in rho
+#define FACTOR_RHO_BATCH 128
+
+// States returned by rsa_factor_step() and rsa_factor_status()
+#define FACTOR_RUNNING 1
+#define FACTOR_FOUND 2
+#define FACTOR_PRIME 3
+
+// The method that split n
+enum FactorMethod {
+    FACTOR_TRIAL = 1,
+    FACTOR_RHO = 2,
+    FACTOR_ECM = 3
+};
+
+// ECM stage 1 bounds by curves already run, after the usual tables for
+// 15-, 20-, 25- and 30-digit factors; the curve counts are roughly doubled
+// since there is no stage 2
+static const struct {
+    int curves;
+    uint32_t b1;
+} ecmSchedule[] = {
+    {0, 2000}, {50, 11000}, {230, 50000}, {830, 250000}, {2230, 1000000}
+};
+
+struct FactorSearch {
+    BigInt n;
+    MontContext mont;
+    std::vector<uint32_t> primes; // primes up to the current ECM bound
+    int rhoRuns;                  // rho runs started
+    int curves;                   // ECM curves started
+    uint32_t b1;                  // bound of the latest curves
+    std::atomic<uint64_t> rhoSteps;
+    std::atomic<int> curvesDone;
+    double rhoSeconds, ecmSeconds;
+    std::atomic<bool> found;
+    std::mutex foundMutex;
+    BigInt factor;
+    int method;
+    bool prime;
+};
+
+// Record a factor 1 < g < n; the first one reported wins
+static void factorFound(FactorSearch* s, const BigInt& g, int method) {
+    std::lock_guard<std::mutex> lock(s->foundMutex);
+    if (s->found.load()) return;
+    s->factor = g;
+    s->method = method;
+    s->found = true;
+}
+
+// gcd(x, n) for a k-limb residue x, reported if it is a proper factor.
+// Returns 1 for a proper factor, 0 for gcd 1 and -1 for gcd n.
+static int factorGcd(FactorSearch* s, const uint32_t* x, int method) {
+    BigInt a, g;
+    for (int i = 0; i < s->mont.k; i++) a.limb[i] = x[i];
+    a.size = s->mont.k;
+    bigTrim(a);
+    bigGcd(a, s->n, g);
+    if (g.size == 1 && g.limb[0] == 1) return 0;
+    if (bigCompare(g, s->n) == 0) return -1;
+    factorFound(s, g, method);
     return 1;
 }
 
+// Pollard's rho on x -> x^2 + c from y with Brent's cycle detection,
+// for at most FACTOR_RHO_STEPS steps. The differences |x - y| are
+// multiplied together and gcd'd with n once per FACTOR_RHO_BATCH steps;
+// if a batch overshoots to gcd n, it is replayed a step at a time.
+// Values stay in Montgomery form, which changes c but not the gcds.
+static void rhoRun(FactorSearch* s, const uint32_t* y0, const uint32_t* c) {
+    const MontContext& ctx = s->mont;
+    int k = ctx.k;
+    uint32_t x[MONT_LIMBS], y[MONT_LIMBS], ys[MONT_LIMBS], q[MONT_LIMBS], d[MONT_LIMBS];
+    for (int i = 0; i < k; i++) {
+        y[i] = y0[i];
+        q[i] = ctx.one[i];
+    }
+    uint64_t steps = 0;
+    int result = 0;
+    for (uint64_t r = 1; result == 0 && steps < FACTOR_RHO_STEPS && !s->found.load(); r *= 2) {
+        for (int i = 0; i < k; i++) x[i] = y[i];
+        for (uint64_t j = 0; j < r; j++) {
+            montSqr(ctx, y, y);
+            montAdd(ctx, y, c, y);
+        }
+        steps += r;
+        for (uint64_t done = 0; done < r && result == 0; done += FACTOR_RHO_BATCH) {
+            for (int i = 0; i < k; i++) ys[i] = y[i];
+            uint64_t batch = (r - done < FACTOR_RHO_BATCH) ? r - done : FACTOR_RHO_BATCH;
+            for (uint64_t j = 0; j < batch; j++) {
+                montSqr(ctx, y, y);
+                montAdd(ctx, y, c, y);
+                montSub(ctx, x, y, d);
+                montMul(ctx, q, d, q);
+            }
+            steps += batch;
+            result = factorGcd(s, q, FACTOR_RHO);
+        }
+    }
+    if (result < 0) {
+        // The batch overshot to gcd n: replay it from ys, one gcd per step
+        for (int j = 0; j < FACTOR_RHO_BATCH; j++) {
+            montSqr(ctx, ys, ys);
+            montAdd(ctx, ys, c, ys);
+            montSub(ctx, x, ys, d);
+            // A factor, or gcd n if the cycle closed mod every prime at once
+            if (factorGcd(s, d, FACTOR_RHO) != 0) break;
+        }
+    }
+    s->rhoSteps += steps;
+}
+
+// A point (X : Z) on a Montgomery curve By^2 = x^3 + Ax^2 + x, with
+// a24 = (A + 2) / 4; coordinates in Montgomery form
+struct EcmPoint {
+    uint32_t x[MONT_LIMBS];
+    uint32_t z[MONT_LIMBS];
+};
+
+// r = 2p
+static void ecmDouble(const MontContext& ctx, const uint32_t* a24, const EcmPoint& p, EcmPoint& r) {
+    uint32_t s[MONT_LIMBS], d[MONT_LIMBS], t[MONT_LIMBS];
+    montAdd(ctx, p.x, p.z, s);
+    montSqr(ctx, s, s);
+    montSub(ctx, p.x, p.z, d);
+    montSqr(ctx, d, d);
+    montSub(ctx, s, d, t);
+    montMul(ctx, s, d, r.x);
+    montMul(ctx, a24, t, s);
+    montAdd(ctx, s, d, s);
+    montMul(ctx, t, s, r.z);
+}
+
+// r = p + q given diff = p - q. r may alias p or q.
+static void ecmAdd(const MontContext& ctx, const EcmPoint& p, const EcmPoint& q, const EcmPoint& diff, EcmPoint& r) {
+    uint32_t u[MONT_LIMBS], v[MONT_LIMBS], t[MONT_LIMBS];
+    montSub(ctx, p.x, p.z, u);
+    montAdd(ctx, q.x, q.z, t);
+    montMul(ctx, u, t, u);
+    montAdd(ctx, p.x, p.z, v);
+    montSub(ctx, q.x, q.z, t);
+    montMul(ctx, v, t, v);
+    montAdd(ctx, u, v, t);
+    montSqr(ctx, t, t);
+    montSub(ctx, u, v, u);
+    montSqr(ctx, u, u);
+    montMul(ctx, diff.z, t, r.x);
+    montMul(ctx, diff.x, u, r.z);
+}
+
+// p = m * p by the Montgomery ladder, for m >= 1
+static void ecmMultiply(const MontContext& ctx, const uint32_t* a24, EcmPoint& p, uint64_t m) {
+    EcmPoint r0 = p;
+    EcmPoint r1;
+    ecmDouble(ctx, a24, p, r1);
+    int top = 63;
+    while (!((m >> top) & 1)) top--;
+    for (int bit = top - 1; bit >= 0; bit--) {
+        if ((m >> bit) & 1) {
+            ecmAdd(ctx, r0, r1, p, r0);
+            ecmDouble(ctx, a24, r1, r1);
+        } else {
+            ecmAdd(ctx, r0, r1, p, r1);
+            ecmDouble(ctx, a24, r0, r0);
+        }
+    }
+    p = r0;
+}
+
+// One ECM curve, by Suyama's parametrization from sigma >= 6:
+// u = sigma^2 - 5, v = 4 sigma, P = (u^3 : v^3) and
+// a24 = (v - u)^3 (3u + v) / (16 u^3 v). Stage 1 multiplies P by every
+// prime power up to b1; if the curve's order mod some prime p | n has only
+// such factors, P becomes the identity mod p and p divides Z.
+static void ecmCurve(FactorSearch* s, uint32_t sigma, uint32_t b1) {
+    const MontContext& ctx = s->mont;
+    BigInt t;
+    uint32_t u[MONT_LIMBS], v[MONT_LIMBS], a[MONT_LIMBS], b[MONT_LIMBS], a24[MONT_LIMBS];
+    bigSetU64(t, (uint64_t)sigma * sigma - 5);
+    montToDomain(ctx, t, u);
+    bigSetU64(t, 4 * (uint64_t)sigma);
+    montToDomain(ctx, t, v);
+
+    EcmPoint p;
+    montSqr(ctx, u, p.x);
+    montMul(ctx, p.x, u, p.x);   // u^3
+    montSqr(ctx, v, p.z);
+    montMul(ctx, p.z, v, p.z);   // v^3
+    montSub(ctx, v, u, a);
+    montSqr(ctx, a, b);
+    montMul(ctx, a, b, a);       // (v - u)^3
+    montAdd(ctx, u, u, b);
+    montAdd(ctx, b, u, b);
+    montAdd(ctx, b, v, b);
+    montMul(ctx, a, b, a);       // (v - u)^3 (3u + v)
+    montMul(ctx, p.x, v, b);
+    for (int i = 0; i < 4; i++) montAdd(ctx, b, b, b); // 16 u^3 v
+
+    // The denominator's inverse; a failed inversion is itself a gcd hit
+    BigInt den, inv;
+    montFromDomain(ctx, b, den);
+    if (!bigModInverse(den, s->n, inv)) {
+        factorGcd(s, b, FACTOR_ECM);
+        return;
+    }
+    montToDomain(ctx, inv, b);
+    montMul(ctx, a, b, a24);
+
+    for (size_t i = 0; i < s->primes.size() && s->primes[i] <= b1; i++) {
+        uint64_t q = s->primes[i];
+        uint64_t power = q;
+        while (power * q <= b1) power *= q;
+        ecmMultiply(ctx, a24, p, power);
+        if (i % 256 == 0 && s->found.load(std::memory_order_relaxed)) return;
+    }
+    factorGcd(s, p.z, FACTOR_ECM);
+}
+
+// Fill s->primes with every prime up to limit
+static void factorSievePrimes(FactorSearch* s, uint32_t limit) {
+    std::vector<uint8_t> composite(limit + 1, 0);
+    s->primes.clear();
+    for (uint32_t i = 2; i <= limit; i++) {
+        if (composite[i]) continue;
+        s->primes.push_back(i);
+        for (uint64_t m = (uint64_t)i * i; m <= limit; m += i) composite[m] = 1;
+    }
+}
+
+// A random residue below n, in k limbs
+static bool factorRandom(const FactorSearch* s, uint32_t* out) {
+    BigInt r;
+    if (!randomBits(r, bigBitLength(s->n) + 32)) return false;
+    bigMod(r, s->n, r);
+    for (int i = 0; i < s->mont.k; i++) out[i] = (i < r.size) ? r.limb[i] : 0;
+    return true;
+}
+
+// Copy a string into malloc'd memory for the JS caller
+static const char* toCString(const std::string& result) {
+    char* return_string = (char*)malloc(result.length() + 1);
+    strncpy(return_string, result.c_str(), result.length());
+    return_string[result.length()] = '\0';
+    return return_string;
+}
+
 extern "C" {
-    EMSCRIPTEN_KEEPALIVE const char* generate_keys() {
-        srand(time(0));
-        ll p = 0, q = 0;
-        // Find two small prime numbers
-        while (!is_prime(p)) p = (rand() % 100) + 50;
-        while (!is_prime(q) || p == q) q = (rand() % 100) + 50;
-
-        ll n = p * q;
-        ll phi = (p - 1) * (q - 1);
-        ll e = 2;
-        while (e < phi) {
-            if (std::gcd(e, phi) == 1) break;
-            e++;
-        }
-        ll d = modInverse(e, phi);
-        
-        std::string result = std::to_string(n) + "," + std::to_string(e) + "," + std::to_string(d);
-        char* return_string = (char*)malloc(result.length() + 1);
-        strncpy(return_string, result.c_str(), result.length());
-        return_string[result.length()] = '\0';
-        return return_string;
-    }
-
-    EMSCRIPTEN_KEEPALIVE const char* process_rsa(const char* text, ll n, ll key) {
+    // Generate a key pair with a `bits`-bit modulus (32 to 4096).
+    // Returns "n,e,d,p,q,dP,dQ,qInv" in decimal, or 0 on error; the last
+    // six fields are the private key for process_rsa() and rsa_decrypt().
+    EMSCRIPTEN_KEEPALIVE const char* generate_keys(int bits) {
+        if (bits < 32 || bits > BIGINT_MAX_BITS) {
+            return 0; // Error: unsupported key size
+        }
+
+        const uint32_t e = RSA_PUBLIC_EXPONENT;
+        BigInt p, q, n;
+        do {
+            if (!randomPrime(p, (bits + 1) / 2, e) || !randomPrime(q, bits / 2, e)) {
+                return 0; // Error: no random source
+            }
+        } while (bigCompare(p, q) == 0);
+        bigMul(p, q, n);
+
+        BigInt pm1 = p, qm1 = q, phi, eBig, d;
+        bigSubSmall(pm1, 1);
+        bigSubSmall(qm1, 1);
+        bigMul(pm1, qm1, phi);
+        bigSetU64(eBig, e);
+        bigModInverse(eBig, phi, d);
+
+        // CRT components, with p > q
+        if (bigCompare(p, q) < 0) {
+            BigInt swap = p;
+            p = q;
+            q = swap;
+            swap = pm1;
+            pm1 = qm1;
+            qm1 = swap;
+        }
+        BigInt dP, dQ, qInv;
+        bigMod(d, pm1, dP);
+        bigMod(d, qm1, dQ);
+        bigModInverse(q, p, qInv);
+
+        std::string result = bigToString(n) + "," + std::to_string(e) + "," + bigToString(d) + "," +
+                             bigToString(p) + "," + bigToString(q) + "," + bigToString(dP) + "," +
+                             bigToString(dQ) + "," + bigToString(qInv);
+        return toCString(result);
+    }
+
+    // Encrypt text character by character into comma-separated decimal
+    // numbers, or decrypt such a list back to text. n and key are decimal
+    // strings: key is e to encrypt, and d or "d,p,q,dP,dQ,qInv" to decrypt
+    // (the latter takes the CRT path). Returns 0 on error.
+    EMSCRIPTEN_KEEPALIVE const char* process_rsa(const char* text, const char* n_str, const char* key_str, bool encrypt) {
+        BigInt n, key;
+        RsaPrivateKey priv;
+        if (!text || !key_str || !bigFromString(n_str, n) || bigBitLength(n) < 2) {
+            return 0; // Error: invalid key
+        }
+        if (encrypt ? !bigFromString(key_str, key) : !parsePrivateKey(n, key_str, priv)) {
+            return 0; // Error: invalid key
+        }
+
         std::string input(text);
         std::string result = "";
-        bool first = true;
+        BigInt num, out;
 
-        if (key > 0) { // Encrypting or Decrypting a numeric string
+        if (!encrypt) { // Decrypting a numeric string
              std::string current_num_str;
-             for(char c : input) {
+             input += ',';
+             for (char c : input) {
                  if (c == ',') {
-                     ll num = std::stoll(current_num_str);
-                     result += (char)power(num, key, n);
+                     if (current_num_str.empty()) continue;
+                     if (!bigFromString(current_num_str.c_str(), num)) {
+                         return 0; // Error: not a number
+                     }
+                     rsaPrivate(priv, num, out);
+                     result += (char)(out.size ? out.limb[0] : 0);
                      current_num_str = "";
-                 } else {
+                 } else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
                      current_num_str += c;
                  }
              }
-             if (!current_num_str.empty()) {
-                  ll num = std::stoll(current_num_str);
-                  result += (char)power(num, key, n);
-             }
         } else { // Encrypting a plain text string
+            bool first = true;
             for (char c : input) {
                 if (!first) result += ",";
-                result += std::to_string(power(c, -key, n));
+                bigSetU64(num, (uint8_t)c);
+                bigPowMod(num, key, n, out);
+                result += bigToString(out);
                 first = false;
             }
         }
 
-        char* return_string = (char*)malloc(result.length() + 1);
-        strncpy(return_string, result.c_str(), result.length());
-        return_string[result.length()] = '\0';
-        return return_string;
+        return toCString(result);
+    }
+
+    // Parse a key once for rsa_batch_process(). n is decimal; e (decimal)
+    // enables encryption and key_str ("d" or "d,p,q,dP,dQ,qInv", as for
+    // process_rsa()) enables decryption; either may be null or empty but
+    // not both. Returns a handle, or 0 on error.
+    EMSCRIPTEN_KEEPALIVE RsaKey* rsa_create_key(const char* n_str, const char* e_str, const char* key_str) {
+        bool hasPublic = e_str && *e_str;
+        bool hasPrivate = key_str && *key_str;
+        if (!n_str || (!hasPublic && !hasPrivate)) {
+            return 0; // Error: no key
+        }
+
+        RsaKey* key = new (std::nothrow) RsaKey;
+        if (!key) {
+            return 0; // Error: out of memory
+        }
+        key->hasPublic = hasPublic;
+        key->hasPrivate = hasPrivate;
+        if (!bigFromString(n_str, key->n) || !montSetup(key->montN, key->n) ||
+            (hasPublic && !bigFromString(e_str, key->e)) || (hasPrivate && !parsePrivateKey(key->n, key_str, key->priv))) {
+            delete key;
+            return 0; // Error: invalid key
+        }
+        key->k = (bigBitLength(key->n) + 7) / 8;
+        return key;
+    }
+
+    // Wipe and release a handle from rsa_create_key()
+    EMSCRIPTEN_KEEPALIVE int rsa_destroy_key(RsaKey* key) {
+        if (!key) {
+            return 0; // Error: null pointer
+        }
+
+        volatile uint8_t* wipe = (volatile uint8_t*)key;
+        for (unsigned i = 0; i < sizeof(RsaKey); i++) {
+            wipe[i] = 0;
+        }
+        delete key;
+        return 1; // Success
     }
-}
\ No newline at end of file
+
+    // Output bytes rsa_batch_process() needs for the count messages in
+    // offsets (see there), or -1 on error
+    EMSCRIPTEN_KEEPALIVE int rsa_batch_size(const RsaKey* key, const int* offsets, int count, int padding, bool encrypt) {
+        if (!key || !offsets || count < 0 || rsaBlockCapacity(key->k, padding) == 0) {
+            return -1; // Error: invalid arguments
+        }
+
+        int64_t total = 0;
+        for (int i = 0; i < count; i++) {
+            int len = offsets[i + 1] - offsets[i];
+            int size = encrypt ? rsaEncryptedSize(key->k, len, padding) : len;
+            if (len < 0 || size < 0) {
+                return -1; // Error: invalid offsets
+            }
+            total += size;
+        }
+        if (total > 0x7fffffff) {
+            return -1; // Error: too long
+        }
+        return (int)total;
+    }
+
+    // Encrypt or decrypt count messages under one key. Message i is
+    // data[offsets[i], offsets[i + 1]); its result lands in
+    // output[out_offsets[i], out_offsets[i + 1]), so offsets and
+    // out_offsets hold count + 1 entries and output rsa_batch_size() bytes.
+    // Messages run in parallel when threads are available. status, if not
+    // null, gets 1 per message that succeeded and 0 per failure (a failed
+    // message has an empty range). Returns the number of failures, or -1 if
+    // the arguments are invalid.
+    EMSCRIPTEN_KEEPALIVE int rsa_batch_process(const RsaKey* key, const uint8_t* data, const int* offsets, int count,
+                                               int padding, bool encrypt, uint8_t* output, int* out_offsets,
+                                               uint8_t* status) {
+        if (!key || !data || !output || !out_offsets || (encrypt ? !key->hasPublic : !key->hasPrivate)) {
+            return -1; // Error: null pointers or missing key half
+        }
+        if (rsa_batch_size(key, offsets, count, padding, encrypt) < 0) {
+            return -1; // Error: invalid offsets
+        }
+
+        // Each message is processed into a slot sized for its worst case
+        // (its exact ciphertext size to encrypt, its input size to decrypt);
+        // the slots are then packed together in order
+        std::vector<int> slot(count + 1);
+        std::vector<int> used(count);
+        slot[0] = 0;
+        for (int i = 0; i < count; i++) {
+            int len = offsets[i + 1] - offsets[i];
+            slot[i + 1] = slot[i] + (encrypt ? rsaEncryptedSize(key->k, len, padding) : len);
+        }
+        parallelFor(count, [&](int i) {
+            const uint8_t* in = data + offsets[i];
+            int len = offsets[i + 1] - offsets[i];
+            uint8_t* out = output + slot[i];
+            used[i] = encrypt ? rsaEncryptMessage(*key, in, len, padding, out) : rsaDecryptMessage(*key, in, len, padding, out);
+        });
+
+        int failures = 0;
+        out_offsets[0] = 0;
+        for (int i = 0; i < count; i++) {
+            int len = used[i];
+            if (len < 0) {
+                failures++;
+                len = 0;
+            }
+            if (status) status[i] = (used[i] >= 0);
+            memmove(output + out_offsets[i], output + slot[i], len);
+            out_offsets[i + 1] = out_offsets[i] + len;
+        }
+        return failures;
+    }
+
+    // Bytes rsa_encrypt() writes for data_len bytes under the decimal
+    // modulus n, or -1 on error. Each block of len(n) bytes carries up to
+    // len(n) - 11 message bytes with PKCS#1 v1.5 padding and len(n) - 66
+    // with OAEP; an empty message still takes one block.
+    EMSCRIPTEN_KEEPALIVE int rsa_encrypted_size(const char* n_str, int data_len, int padding) {
+        BigInt n;
+        if (!n_str || !bigFromString(n_str, n)) {
+            return -1; // Error: invalid modulus
+        }
+        return rsaEncryptedSize((bigBitLength(n) + 7) / 8, data_len, padding);
+    }
+
+    // Encrypt data_len bytes with the public key (n, e), both decimal,
+    // into big-endian blocks of len(n) bytes; output holds
+    // rsa_encrypted_size() bytes. Returns the bytes written, or -1 on error.
+    EMSCRIPTEN_KEEPALIVE int rsa_encrypt(const uint8_t* data, int data_len, const char* n_str, const char* e_str,
+                                         int padding, uint8_t* output) {
+        if ((!data && data_len) || !output || !e_str) {
+            return -1; // Error: null pointers
+        }
+        RsaKey* key = rsa_create_key(n_str, e_str, 0);
+        if (!key) {
+            return -1; // Error: invalid key
+        }
+        int written = -1;
+        if (rsaEncryptedSize(key->k, data_len, padding) >= 0) {
+            written = rsaEncryptMessage(*key, data, data_len, padding, output);
+        }
+        rsa_destroy_key(key);
+        return written;
+    }
+
+    // Decrypt rsa_encrypt() output. key is d or "d,p,q,dP,dQ,qInv" in
+    // decimal as for process_rsa(). output needs data_len bytes. Returns
+    // the message length, or -1 on error (including any badly padded block).
+    EMSCRIPTEN_KEEPALIVE int rsa_decrypt(const uint8_t* data, int data_len, const char* n_str, const char* key_str,
+                                         int padding, uint8_t* output) {
+        if (!data || !output || !key_str) {
+            return -1; // Error: null pointers
+        }
+        RsaKey* key = rsa_create_key(n_str, 0, key_str);
+        if (!key) {
+            return -1; // Error: invalid key
+        }
+        int written = -1;
+        if (rsaBlockCapacity(key->k, padding) > 0) {
+            written = rsaDecryptMessage(*key, data, data_len, padding, output);
+        }
+        rsa_destroy_key(key);
+        return written;
+    }
+
+    // Start factoring n (decimal, or hex with 0x), 4 <= n < 2^256. Trial
+    // division runs here; rsa_factor_step() does the rest. Returns a handle,
+    // or 0 on error.
+    EMSCRIPTEN_KEEPALIVE FactorSearch* rsa_factor_create(const char* n_str) {
+        BigInt n;
+        if (!n_str || !bigFromString(n_str, n) || bigBitLength(n) < 3 || bigBitLength(n) > FACTOR_MAX_BITS) {
+            return 0; // Error: invalid or unsupported modulus
+        }
+
+        FactorSearch* s = new (std::nothrow) FactorSearch();
+        if (!s) {
+            return 0; // Error: out of memory
+        }
+        s->n = n;
+        s->rhoRuns = 0;
+        s->curves = 0;
+        s->b1 = 0;
+        s->rhoSteps = 0;
+        s->curvesDone = 0;
+        s->rhoSeconds = 0;
+        s->ecmSeconds = 0;
+        s->found = false;
+        s->method = 0;
+        s->prime = is_prime(n);
+        if (s->prime) return s;
+
+        BigInt g;
+        if (!bigIsOdd(n)) {
+            bigSetU64(g, 2);
+            factorFound(s, g, FACTOR_TRIAL);
+            return s;
+        }
+        for (uint16_t p : smallPrimes.p) {
+            if (bigModSmall(n, p) == 0) {
+                bigSetU64(g, p);
+                factorFound(s, g, FACTOR_TRIAL);
+                return s;
+            }
+        }
+        montSetup(s->mont, n);
+        return s;
+    }
+
+    // Run rounds of work, one rho run or ECM curve per thread, until a
+    // factor turns up or max_seconds have passed (at least one round runs).
+    // Returns FACTOR_RUNNING, FACTOR_FOUND or FACTOR_PRIME, or 0 on error.
+    EMSCRIPTEN_KEEPALIVE int rsa_factor_step(FactorSearch* s, double max_seconds) {
+        if (!s) {
+            return 0; // Error: null pointer
+        }
+        if (s->prime) {
+            return FACTOR_PRIME;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (!s->found.load()) {
+            int threads = parallelThreads();
+            auto roundStart = std::chrono::steady_clock::now();
+            if (s->rhoRuns < FACTOR_RHO_RUNS) {
+                int runs = (FACTOR_RHO_RUNS - s->rhoRuns < threads) ? FACTOR_RHO_RUNS - s->rhoRuns : threads;
+                parallelFor(runs, [&](int) {
+                    uint32_t y0[MONT_LIMBS], c[MONT_LIMBS];
+                    if (factorRandom(s, y0) && factorRandom(s, c)) rhoRun(s, y0, c);
+                });
+                s->rhoRuns += runs;
+                s->rhoSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - roundStart).count();
+            } else {
+                uint32_t b1 = 0;
+                for (const auto& stage : ecmSchedule) {
+                    if (s->curves >= stage.curves) b1 = stage.b1;
+                }
+                if (b1 != s->b1) {
+                    factorSievePrimes(s, b1);
+                    s->b1 = b1;
+                }
+                parallelFor(threads, [&](int) {
+                    uint32_t sigma;
+                    if (!randomBytes((uint8_t*)&sigma, 4)) return;
+                    ecmCurve(s, 6 + sigma % 0x7ffffff0, b1);
+                    s->curvesDone++;
+                });
+                s->curves += threads;
+                s->ecmSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - roundStart).count();
+            }
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= max_seconds) break;
+        }
+        return s->found.load() ? FACTOR_FOUND : FACTOR_RUNNING;
+    }
+
+    // Progress of a factorization. stats (6 doubles, may be null) receives
+    // rho steps, rho steps per second, ECM curves completed, curves per
+    // second, the current ECM bound B1 and the seconds spent in
+    // rsa_factor_step() (the time to factor once found). Returns the state
+    // as rsa_factor_step() does, or 0 on error.
+    EMSCRIPTEN_KEEPALIVE int rsa_factor_status(const FactorSearch* s, double* stats) {
+        if (!s) {
+            return 0; // Error: null pointer
+        }
+
+        if (stats) {
+            stats[0] = (double)s->rhoSteps.load();
+            stats[1] = (s->rhoSeconds > 0) ? stats[0] / s->rhoSeconds : 0;
+            stats[2] = (double)s->curvesDone.load();
+            stats[3] = (s->ecmSeconds > 0) ? stats[2] / s->ecmSeconds : 0;
+            stats[4] = (double)s->b1;
+            stats[5] = s->rhoSeconds + s->ecmSeconds;
+        }
+        if (s->prime) {
+            return FACTOR_PRIME;
+        }
+        return s->found.load() ? FACTOR_FOUND : FACTOR_RUNNING;
+    }
+
+    // The split once found, as "p,q,method" with p <= q in decimal and
+    // method "trial", "rho" or "ecm". p and q need not be prime when n has
+    // more than two factors. Returns 0 until a factor is found.
+    EMSCRIPTEN_KEEPALIVE const char* rsa_factor_result(const FactorSearch* s) {
+        if (!s || !s->found.load()) {
+            return 0; // Error: no factor yet
+        }
+
+        BigInt p = s->factor;
+        BigInt q;
+        bigDivMod(s->n, p, &q, nullptr);
+        if (bigCompare(p, q) > 0) {
+            BigInt swap = p;
+            p = q;
+            q = swap;
+        }
+        static const char* const methods[] = {"", "trial", "rho", "ecm"};
+        return toCString(bigToString(p) + "," + bigToString(q) + "," + methods[s->method]);
+    }
+
+    // Release a factorization from rsa_factor_create()
+    EMSCRIPTEN_KEEPALIVE int rsa_factor_destroy(FactorSearch* s) {
+        if (!s) {
+            return 0; // Error: null pointer
+        }
+
+        delete s;
+        return 1; // Success
+    }
+}